@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include "sys.h"
+
+namespace lib {
+
+// Monotonic memory arena for batch work, to be passed to the pmr overloads of
+// str and vec functions. Memory is never freed piecewise: all allocations are
+// dropped at once with reset(), and the initial block is reused by the next batch.
+// Example:
+// Arena arena;
+// for (const auto& contents : allContents) {
+//     {
+//         std::pmr::vector<std::pmr::wstring> lines = str::splitLines(arena.mem(), contents);
+//     } // all pmr objects must be destroyed before reset()
+//     arena.reset();
+// }
+class Arena final {
+public:
+	Arena(const Arena&) = delete;
+	Arena(Arena&&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	Arena& operator=(Arena&&) = delete;
+
+	// The initial block is allocated right away; when exhausted, new blocks are
+	// requested from the global heap, in geometric progression.
+	explicit Arena(size_t initialBytes = 64 * 1024)
+		: _initialBlock{std::make_unique_for_overwrite<BYTE[]>(initialBytes)},
+			_res{_initialBlock.get(), initialBytes} { }
+
+	[[nodiscard]] std::pmr::memory_resource* mem() { return &_res; }
+
+	// Releases all allocations at once. Objects using the arena must be destroyed before.
+	void reset() noexcept { _res.release(); }
+
+private:
+	std::unique_ptr<BYTE[]> _initialBlock;
+	std::pmr::monotonic_buffer_resource _res;
+};
+
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "AsyncFile.h"
+using namespace lib;
+
+void AsyncFile::close() noexcept
+{
+	wait();
+	_file.close();
+}
+
+size_t AsyncFile::pending() const
+{
+	std::lock_guard lock{_mtx};
+	return _pending;
+}
+
+const AsyncFile& AsyncFile::readAt(size_t offset, std::span<BYTE> dest, Callback callback) const
+{
+	_submit(false, offset, dest, std::move(callback));
+	return *this;
+}
+
+const AsyncFile& AsyncFile::wait() const
+{
+	std::unique_lock lock{_mtx};
+	_cvDone.wait(lock, [this]() { return !_pending; });
+	return *this;
+}
+
+const AsyncFile& AsyncFile::writeAt(size_t offset, std::span<BYTE> data, Callback callback) const
+{
+	_submit(true, offset, data, std::move(callback));
+	return *this;
+}
+
+AsyncFile::Callback AsyncFile::_tracked(Callback callback) const
+{
+	{
+		std::lock_guard lock{_mtx};
+		++_pending;
+	}
+	return [this, callback = std::move(callback)](size_t numBytes, std::error_code err) {
+		callback(numBytes, err);
+		std::lock_guard lock{_mtx}; // notify while locked, so wait() can't return and destroy us before it
+		if (!--_pending)
+			_cvDone.notify_all();
+	};
+}
+
+#ifdef _WIN32
+// A request in flight, owned by the completion port until completed.
+struct AsyncRequest final {
+	OVERLAPPED ov{}; // first member, so the OVERLAPPED* returned by the port is also the AsyncRequest*
+	AsyncFile::Callback callback;
+	DWORD err = ERROR_SUCCESS; // failure detected at submission
+};
+
+// Process-wide completion port, with its worker threads.
+class Iocp final {
+public:
+	Iocp(const Iocp&) = delete;
+	Iocp(Iocp&&) = delete;
+	Iocp& operator=(const Iocp&) = delete;
+	Iocp& operator=(Iocp&&) = delete;
+
+	Iocp()
+	{
+		_hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 0);
+		if (!_hPort) [[unlikely]] {
+			throw std::system_error(GetLastError(), std::system_category(), "CreateIoCompletionPort failed");
+		}
+		size_t numThreads = std::max(2u, std::thread::hardware_concurrency());
+		for (size_t i = 0; i < numThreads; ++i)
+			_threads.emplace_back([this]() { _loop(); });
+	}
+
+	~Iocp()
+	{
+		for (size_t i = 0; i < _threads.size(); ++i)
+			PostQueuedCompletionStatus(_hPort, 0, 0, nullptr); // a null OVERLAPPED stops a thread
+		for (std::thread& t : _threads)
+			t.join();
+		CloseHandle(_hPort);
+	}
+
+	[[nodiscard]] HANDLE hPort() const { return _hPort; }
+
+private:
+	void _loop() const
+	{
+		for (;;) {
+			DWORD numBytes = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* pOv = nullptr;
+			BOOL ok = GetQueuedCompletionStatus(_hPort, &numBytes, &key, &pOv, INFINITE);
+			if (!pOv) return; // asked to stop, or the port is gone
+
+			std::unique_ptr<AsyncRequest> pReq{reinterpret_cast<AsyncRequest*>(pOv)};
+			DWORD err = ok ? pReq->err : GetLastError();
+			if (err == ERROR_HANDLE_EOF) err = ERROR_SUCCESS; // reading past the end transfers nothing
+			pReq->callback(numBytes, std::error_code(err, std::system_category()));
+		}
+	}
+
+	HANDLE _hPort = nullptr;
+	std::vector<std::thread> _threads;
+};
+
+static Iocp& _iocp()
+{
+	static Iocp iocp; // created on first use
+	return iocp;
+}
+
+AsyncFile& AsyncFile::open(std::wstring_view path, File::Access access)
+{
+	close();
+	_file._open(path, access, File::AccessHint::Normal, true);
+	if (!CreateIoCompletionPort(_file.hFile(), _iocp().hPort(), 0, 0)) [[unlikely]] {
+		DWORD err = GetLastError();
+		_file.close();
+		throw std::system_error(err, std::system_category(), "CreateIoCompletionPort failed");
+	}
+	return *this;
+}
+
+void AsyncFile::_submit(bool isWrite, size_t offset, std::span<BYTE> buf, Callback callback) const
+{
+	auto pReq = std::make_unique<AsyncRequest>();
+	auto off = static_cast<UINT64>(offset); // size_t may be 32-bit
+	pReq->ov.Offset = static_cast<DWORD>(off);
+	pReq->ov.OffsetHigh = static_cast<DWORD>(off >> 32);
+	pReq->callback = _tracked(std::move(callback));
+
+	auto len = static_cast<DWORD>(std::min(buf.size(), size_t{MAXDWORD})); // a single request can't take more than 4 GB
+	BOOL ok = isWrite
+		? WriteFile(_file.hFile(), buf.data(), len, nullptr, &pReq->ov)
+		: ReadFile(_file.hFile(), buf.data(), len, nullptr, &pReq->ov);
+
+	if (!ok) {
+		DWORD err = GetLastError();
+		if (err != ERROR_IO_PENDING) { // failed right away, deliver it through the port anyway
+			pReq->err = err;
+			if (!PostQueuedCompletionStatus(_iocp().hPort(), 0, 0, &pReq->ov)) [[unlikely]] {
+				pReq->callback(0, std::error_code(err, std::system_category())); // still owned here, so delivered inline
+				return;
+			}
+		}
+	}
+	pReq.release(); // owned by the port now, even if completed synchronously
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include "File.h"
+#include "sys.h"
+
+namespace lib {
+
+// File for asynchronous reads and writes at explicit offsets, so many requests can
+// be in flight at once. Backed by overlapped I/O and an I/O completion port on
+// Windows, and by a thread pool running pread()/pwrite() on POSIX. Callbacks run
+// on a worker thread, or rarely on the calling one, if a failed request can't be
+// queued; buffers must stay valid until their callback is called.
+// Example:
+// AsyncFile f{L"C:\\Temp\\foo.bin", File::Access::ExistingReadOnly};
+// std::vector<BYTE> buf(f.size());
+// f.readAt(0, buf, [&](size_t numRead, std::error_code err) {
+//     dlg.postUiThread([&, numRead, err]() { ... }); // continue on the UI thread
+// });
+class AsyncFile final {
+public:
+	// Called when a request completes, with the number of bytes transferred and the
+	// error, if any. Reads past the end of file transfer fewer bytes. Must not throw.
+	using Callback = std::function<void(size_t numBytes, std::error_code err)>;
+
+	~AsyncFile() { close(); }
+
+	AsyncFile() = default;
+	AsyncFile(const AsyncFile&) = delete;
+	AsyncFile(AsyncFile&&) = delete; // pending requests point to it
+	AsyncFile& operator=(const AsyncFile&) = delete;
+	AsyncFile& operator=(AsyncFile&&) = delete;
+
+	AsyncFile(std::wstring_view path, File::Access access) { open(path, access); }
+
+	// Waits for all pending requests, then closes the file. Don't call it from a callback.
+	void close() noexcept;
+	AsyncFile& open(std::wstring_view path, File::Access access);
+	// Returns the number of requests whose callbacks didn't return yet.
+	[[nodiscard]] size_t pending() const;
+	// Queues the reading of dest.size() bytes, starting at offset.
+	const AsyncFile& readAt(size_t offset, std::span<BYTE> dest, Callback callback) const;
+	[[nodiscard]] size_t size() const { return _file.size(); }
+	// Blocks until all pending requests are completed. Don't call it from a callback.
+	const AsyncFile& wait() const;
+	// Queues the writing of data, starting at offset.
+	const AsyncFile& writeAt(size_t offset, std::span<BYTE> data, Callback callback) const;
+
+private:
+	[[nodiscard]] Callback _tracked(Callback callback) const;
+	void _submit(bool isWrite, size_t offset, std::span<BYTE> buf, Callback callback) const;
+
+	File _file;
+	mutable std::mutex _mtx;
+	mutable std::condition_variable _cvDone;
+	mutable size_t _pending = 0;
+};
+
+}
@@ -0,0 +1,105 @@
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "AsyncFile.h"
+using namespace lib;
+
+// POSIX backend of AsyncFile, blocking pread()/pwrite() calls on a thread pool;
+// the Win32 one is in AsyncFile.cpp.
+
+// Process-wide pool of I/O threads.
+class IoPool final {
+public:
+	IoPool(const IoPool&) = delete;
+	IoPool(IoPool&&) = delete;
+	IoPool& operator=(const IoPool&) = delete;
+	IoPool& operator=(IoPool&&) = delete;
+
+	IoPool()
+	{
+		size_t numThreads = std::max(4u, std::thread::hardware_concurrency()); // blocked on I/O, not CPU
+		for (size_t i = 0; i < numThreads; ++i)
+			_threads.emplace_back([this]() { _loop(); });
+	}
+
+	~IoPool()
+	{
+		{
+			std::lock_guard lock{_mtx};
+			_stop = true;
+		}
+		_cvTask.notify_all();
+		for (std::thread& t : _threads)
+			t.join();
+	}
+
+	void push(std::function<void()> task)
+	{
+		{
+			std::lock_guard lock{_mtx};
+			_tasks.emplace_back(std::move(task));
+		}
+		_cvTask.notify_one();
+	}
+
+private:
+	void _loop()
+	{
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock{_mtx};
+				_cvTask.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+				if (_tasks.empty()) return; // asked to stop
+				task = std::move(_tasks.front());
+				_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::mutex _mtx;
+	std::condition_variable _cvTask;
+	std::deque<std::function<void()>> _tasks;
+	bool _stop = false;
+	std::vector<std::thread> _threads;
+};
+
+static IoPool& _ioPool()
+{
+	static IoPool pool; // created on first use
+	return pool;
+}
+
+AsyncFile& AsyncFile::open(std::wstring_view path, File::Access access)
+{
+	close();
+	_file._open(path, access, File::AccessHint::Normal, true);
+	return *this;
+}
+
+void AsyncFile::_submit(bool isWrite, size_t offset, std::span<BYTE> buf, Callback callback) const
+{
+	_ioPool().push([fd = _file.fd(), isWrite, offset, buf, callback = _tracked(std::move(callback))]() {
+		size_t total = 0;
+		int err = 0;
+		while (total < buf.size()) {
+			ssize_t num = isWrite
+				? pwrite(fd, buf.data() + total, buf.size() - total, static_cast<off_t>(offset + total))
+				: pread(fd, buf.data() + total, buf.size() - total, static_cast<off_t>(offset + total));
+			if (num == -1) {
+				if (errno == EINTR) continue; // interrupted by a signal, try again
+				err = errno;
+				break;
+			}
+			if (!num) break; // end of file
+			total += num;
+		}
+		callback(total, std::error_code(err, std::generic_category()));
+	});
+}
+#endif
@@ -7,6 +7,8 @@
 #include <ShObjIdl.h>
 #include "Dialog.h"
 #include "Com.h"
+#include "str.h"
+#include "vec.h"
 using namespace lib;
 
 struct ThreadPack final {
@@ -116,9 +118,8 @@ std::optional<std::vector<std::wstring>> Dialog::Facilities::showOpenFiles(
 			strPaths.emplace_back(_shellItemPath(shi));
 		}
 
-		std::sort(strPaths.begin(), strPaths.end(), [](const auto& a, const auto& b) -> bool {
-			return lstrcmpiW(a.c_str(), b.c_str()) < 1;
-		});
+		vec::sortBy(strPaths, [](const std::wstring& p) -> std::wstring_view { return p; },
+			[](std::wstring_view a, std::wstring_view b) -> bool { return str::cmpI(a, b) < 0; });
 		return strPaths;
 	} else if (hr == HRESULT_FROM_WIN32(ERROR_CANCELLED)) {
 		return std::nullopt;
@@ -305,7 +306,7 @@ INT_PTR CALLBACK Dialog::_DlgProc(HWND hDlg, UINT uMsg, WPARAM wp, LPARAM lp)
 
 	pSelf->_layout.processMsgs(uMsg, wp, lp);
 
-	if (uMsg == WM_THREAD && wp == WM_THREAD) // incoming from another thread through SendMessage()
+	if (uMsg == WM_THREAD && wp == WM_THREAD) // incoming from another thread through SendMessage() or PostMessage()
 		pSelf->_onSentFromOtherThread(lp);
 
 	INT_PTR userRet = pSelf->dlgProc(uMsg, wp, lp);
@@ -354,6 +355,15 @@ void Dialog::_runInUiThread(std::function<void()> callback) const
 	SendMessageW(hWnd(), WM_THREAD, WM_THREAD, reinterpret_cast<LPARAM>(pPack.release()));
 }
 
+bool Dialog::_postToUiThread(std::function<void()> callback) const
+{
+	auto pPack = std::make_unique<ThreadPack>(std::move(callback), nullptr);
+	if (!PostMessageW(hWnd(), WM_THREAD, WM_THREAD, reinterpret_cast<LPARAM>(pPack.get())))
+		return false; // the pack is freed here, the callback won't run
+	pPack.release(); // will be freed by _onSentFromOtherThread()
+	return true;
+}
+
 void Dialog::_onSentFromOtherThread(LPARAM lp) const
 {
 	std::unique_ptr<ThreadPack> pPack{reinterpret_cast<ThreadPack*>(lp)};
@@ -364,7 +374,7 @@ void Dialog::_onSentFromOtherThread(LPARAM lp) const
 			_Lippincott();
 			PostQuitMessage(1);
 		}
-	} else { // from _runInUiThread()
+	} else { // from _runInUiThread() or _postToUiThread()
 		try {
 			pPack->callback();
 		} catch (...) {
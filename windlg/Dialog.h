@@ -38,6 +38,11 @@ private:
 		int msgBox(std::wstring_view title, std::optional<std::wstring_view> mainInstruction,
 			std::wstring_view body, int tdcbfButtons, LPWSTR tdIcon) const;
 
+		// Queues the function to run in the original UI thread, without blocking the current thread. Catches uncaught exceptions.
+		// Returns false if it couldn't be queued, because the window is gone or the queue is full, so the function won't run.
+		// Functions still queued when the window is destroyed never run, and their memory is leaked.
+		bool postUiThread(std::function<void()> callback) const { return _pDlg->_postToUiThread(std::move(callback)); }
+
 		// Calls RegisterDragDrop() to enable onDropTarget() callback. Don't forget to instantiate lib::ComOle.
 		const Facilities& registerDragDrop() const;
 
@@ -129,6 +134,7 @@ protected:
 private:
 	void _launchDetachedThread(std::function<void()> callback) const;
 	void _runInUiThread(std::function<void()> callback) const;
+	bool _postToUiThread(std::function<void()> callback) const;
 	void _onSentFromOtherThread(LPARAM lp) const;
 	Window::_hWndPtr;
 
@@ -1,8 +1,16 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
 #include <system_error>
+#include <thread>
 #include "File.h"
 #include "str.h"
 using namespace lib;
 
+#ifdef _WIN32
 File& File::operator=(File&& other) noexcept
 {
 	close();
@@ -18,7 +26,7 @@ void File::close() noexcept
 	}
 }
 
-File& File::open(std::wstring_view path, Access access)
+File& File::_open(std::wstring_view path, Access access, AccessHint hint, bool overlapped)
 {
 	close();
 	DWORD acc = 0, share = 0, disp = 0;
@@ -42,7 +50,24 @@ File& File::open(std::wstring_view path, Access access)
 		disp = CREATE_NEW;
 	}
 
-	_hFile = CreateFileW(path.data(), acc, share, nullptr, disp, FILE_ATTRIBUTE_NORMAL, nullptr);
+	DWORD flags = FILE_ATTRIBUTE_NORMAL | (overlapped ? FILE_FLAG_OVERLAPPED : 0);
+	switch (hint) {
+	case AccessHint::Normal:
+		break;
+	case AccessHint::Sequential:
+		flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		break;
+	case AccessHint::Random:
+		flags |= FILE_FLAG_RANDOM_ACCESS;
+		break;
+	case AccessHint::WriteThrough:
+		flags |= FILE_FLAG_WRITE_THROUGH;
+		break;
+	case AccessHint::Unbuffered:
+		flags |= FILE_FLAG_NO_BUFFERING;
+	}
+
+	_hFile = CreateFileW(path.data(), acc, share, nullptr, disp, flags, nullptr);
 	if (!_hFile || _hFile == INVALID_HANDLE_VALUE) [[unlikely]] {
 		throw std::system_error(GetLastError(), std::system_category(), "CreateFile failed");
 	}
@@ -58,6 +83,22 @@ size_t File::pointerOffset() const
 	return static_cast<size_t>(curOffset.QuadPart);
 }
 
+size_t File::read(std::span<BYTE> dest, size_t blockSize) const
+{
+	size_t totalRead = 0;
+	while (totalRead < dest.size()) {
+		auto toRead = static_cast<DWORD>(std::min({dest.size() - totalRead, blockSize, size_t{MAXDWORD}}));
+		DWORD numRead = 0;
+		if (!ReadFile(_hFile, dest.data() + totalRead, toRead, &numRead, nullptr)) [[unlikely]] {
+			throw std::system_error(GetLastError(), std::system_category(), "ReadFile failed");
+		}
+		if (!numRead) break; // end of file
+		totalRead += numRead;
+	}
+	return totalRead;
+}
+#endif
+
 std::vector<BYTE> File::readAll() const
 {
 	setPointerOffset(0);
@@ -66,15 +107,63 @@ std::vector<BYTE> File::readAll() const
 	return buf;
 }
 
-const File& File::readBuffer(std::vector<BYTE>& buffer) const
+const File& File::readBuffer(std::vector<BYTE>& buffer, size_t blockSize) const
+{
+	buffer.resize(read(buffer, blockSize)); // file may be shorter than the buffer
+	return *this;
+}
+
+const File& File::readChunks(size_t blockSize, std::function<void(std::span<BYTE>)> callback) const
 {
-	DWORD read = 0;
-	if (!ReadFile(_hFile, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr)) [[unlikely]] {
-		throw std::system_error(GetLastError(), std::system_category(), "ReadFile failed");
+	if (!blockSize) [[unlikely]] {
+		throw std::invalid_argument("Block size must be greater than zero.");
+	}
+
+	std::vector<BYTE> buf(blockSize, 0x00); // reused by all blocks
+	for (;;) {
+		size_t numRead = read(buf, blockSize);
+		if (numRead)
+			callback(std::span{buf.data(), numRead});
+		if (numRead < blockSize) break; // end of file
 	}
 	return *this;
 }
 
+#ifdef _WIN32
+size_t File::readV(std::span<const std::span<BYTE>> buffers) const
+{
+	// ReadFileScatter() needs unbuffered I/O with page-sized buffers, so consecutive
+	// small buffers are read at once into a temporary one, then copied.
+	constexpr size_t COALESCE_MAX = 64 * 1024; // larger buffers are read directly
+	std::vector<BYTE> buf;
+	size_t totalRead = 0;
+
+	for (size_t i = 0; i < buffers.size(); ) {
+		if (buffers[i].size() >= COALESCE_MAX) {
+			size_t numRead = read(buffers[i]);
+			totalRead += numRead;
+			if (numRead < buffers[i++].size()) break; // end of file
+			continue;
+		}
+
+		size_t runEnd = i, runSz = 0;
+		while (runEnd < buffers.size() && buffers[runEnd].size() < COALESCE_MAX
+				&& runSz + buffers[runEnd].size() <= CHUNK_SIZE) {
+			runSz += buffers[runEnd++].size();
+		}
+		buf.resize(runSz);
+		size_t numRead = read(buf);
+		for (size_t off = 0; i < runEnd; ++i) {
+			size_t n = std::min(buffers[i].size(), numRead - off);
+			std::copy_n(buf.begin() + off, n, buffers[i].begin());
+			off += n;
+		}
+		totalRead += numRead;
+		if (numRead < runSz) break; // end of file
+	}
+	return totalRead;
+}
+
 const File& File::setPointerOffset(size_t offset) const
 {
 	LARGE_INTEGER off = {.QuadPart = static_cast<LONGLONG>(offset)};
@@ -122,15 +211,192 @@ File::Times File::times() const
 	return ret;
 }
 
-const File& File::write(std::span<BYTE> data) const
+const File& File::write(std::span<const BYTE> data) const
 {
-	DWORD written = 0;
-	if (!WriteFile(_hFile, data.data(), static_cast<DWORD>(data.size_bytes()), &written, nullptr)) [[unlikely]] {
-		throw std::system_error(GetLastError(), std::system_category(), "WriteFile failed");
+	while (!data.empty()) { // a single WriteFile() can't take more than 4 GB
+		auto toWrite = static_cast<DWORD>(std::min(data.size_bytes(), size_t{MAXDWORD}));
+		DWORD written = 0;
+		if (!WriteFile(_hFile, data.data(), toWrite, &written, nullptr)) [[unlikely]] {
+			throw std::system_error(GetLastError(), std::system_category(), "WriteFile failed");
+		}
+		data = data.subspan(written);
 	}
 	return *this;
 }
 
+void File::_Remove(std::wstring_view path) noexcept
+{
+	DeleteFileW(path.data());
+}
+
+bool File::_SameFile(const File& a, const File& b)
+{
+	BY_HANDLE_FILE_INFORMATION infoA{}, infoB{};
+	if (!GetFileInformationByHandle(a._hFile, &infoA) || !GetFileInformationByHandle(b._hFile, &infoB)) [[unlikely]] {
+		throw std::system_error(GetLastError(), std::system_category(), "GetFileInformationByHandle failed");
+	}
+	return infoA.dwVolumeSerialNumber == infoB.dwVolumeSerialNumber
+		&& infoA.nFileIndexHigh == infoB.nFileIndexHigh
+		&& infoA.nFileIndexLow == infoB.nFileIndexLow;
+}
+
+const File& File::writeV(std::span<const std::span<const BYTE>> buffers) const
+{
+	// WriteFileGather() needs unbuffered I/O with page-sized buffers, so consecutive
+	// small buffers are copied into a temporary one, then written at once.
+	constexpr size_t COALESCE_MAX = 64 * 1024; // larger buffers are written directly
+	size_t totalSz = 0;
+	for (const auto& data : buffers)
+		totalSz += data.size();
+
+	std::vector<BYTE> buf;
+	buf.reserve(std::min(totalSz, CHUNK_SIZE));
+
+	for (const auto& data : buffers) {
+		if (data.size() >= COALESCE_MAX || buf.size() + data.size() > CHUNK_SIZE) {
+			write(buf);
+			buf.clear();
+		}
+		if (data.size() >= COALESCE_MAX)
+			write(data);
+		else
+			buf.insert(buf.end(), data.begin(), data.end());
+	}
+	return write(buf);
+}
+#endif
+
+struct CopyPipeline final { // buffers handed from the reader thread to the writer
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::vector<size_t> lens; // bytes held by each buffer
+	size_t numFilled = 0, numWritten = 0; // the n-th buffer is always n % lens.size()
+	bool eof = false, abort = false;
+	std::exception_ptr err;
+};
+
+bool File::Copy(std::wstring_view src, std::wstring_view dst, const CopyOptions& options)
+{
+	constexpr size_t ALIGN = 4096; // sector size multiple, required by unbuffered writes
+	size_t bufSz = (std::max(options.bufferSize, ALIGN) + ALIGN - 1) / ALIGN * ALIGN;
+	size_t numBufs = std::max(options.numBuffers, size_t{2});
+
+	File fin{src, Access::ExistingReadOnly, AccessHint::Sequential};
+	size_t total = fin.size();
+	File fout{dst, Access::OpenOrCreateRW, options.unbuffered ? AccessHint::Unbuffered : AccessHint::Sequential};
+	if (_SameFile(fin, fout)) [[unlikely]] { // truncating dst would destroy src
+		throw std::invalid_argument("Copy source and destination are the same file.");
+	}
+	fout.setSize(0);
+
+	auto discardDst = [&]() { // a partial copy is never left behind
+		fout.close();
+		_Remove(dst);
+	};
+
+	std::vector<BYTE> mem(bufSz * numBufs + ALIGN); // all buffers in a single aligned block
+	BYTE* pBufs = mem.data() + (ALIGN - reinterpret_cast<uintptr_t>(mem.data()) % ALIGN) % ALIGN;
+	auto buffer = [&](size_t n) { return std::span{pBufs + (n % numBufs) * bufSz, bufSz}; };
+
+	CopyPipeline pipe;
+	pipe.lens.resize(numBufs);
+
+	std::thread reader([&]() {
+		try {
+			for (;;) {
+				{
+					std::unique_lock lock{pipe.mtx};
+					pipe.cv.wait(lock, [&]() { return pipe.abort || pipe.numFilled - pipe.numWritten < numBufs; });
+					if (pipe.abort) return;
+				}
+				size_t numRead = fin.read(buffer(pipe.numFilled)); // numFilled is only changed by this thread
+				std::lock_guard lock{pipe.mtx};
+				pipe.lens[pipe.numFilled % numBufs] = numRead;
+				if (numRead) ++pipe.numFilled;
+				pipe.eof = (numRead < bufSz);
+				pipe.cv.notify_all();
+				if (pipe.eof) return;
+			}
+		} catch (...) {
+			std::lock_guard lock{pipe.mtx};
+			pipe.err = std::current_exception();
+			pipe.eof = true;
+			pipe.cv.notify_all();
+		}
+	});
+
+	auto stopReader = [&]() {
+		{
+			std::lock_guard lock{pipe.mtx};
+			pipe.abort = true;
+		}
+		pipe.cv.notify_all();
+		reader.join();
+	};
+
+	size_t copied = 0;
+	bool cancelled = false;
+	auto lastProgress = std::chrono::steady_clock::now();
+	try {
+		while (!(cancelled = options.stopToken.stop_requested())) {
+			size_t len = 0;
+			{
+				std::unique_lock lock{pipe.mtx};
+				pipe.cv.wait(lock, [&]() { return pipe.numWritten < pipe.numFilled || pipe.eof; });
+				if (pipe.numWritten == pipe.numFilled) break; // reader finished
+				len = pipe.lens[pipe.numWritten % numBufs];
+			}
+
+			std::span<BYTE> buf = buffer(pipe.numWritten);
+			size_t toWrite = len;
+			if (options.unbuffered) { // last block is padded to the sector size, and truncated later
+				toWrite = (len + ALIGN - 1) / ALIGN * ALIGN;
+				std::fill(buf.begin() + len, buf.begin() + toWrite, 0x00);
+			}
+			fout.write(buf.first(toWrite));
+			copied += len;
+
+			{
+				std::lock_guard lock{pipe.mtx};
+				++pipe.numWritten;
+			}
+			pipe.cv.notify_all();
+
+			auto now = std::chrono::steady_clock::now();
+			if (options.onProgress && now - lastProgress >= std::chrono::milliseconds{options.progressIntervalMs}) {
+				options.onProgress(copied, total);
+				lastProgress = now;
+			}
+		}
+	} catch (...) {
+		stopReader();
+		discardDst();
+		throw;
+	}
+
+	stopReader();
+	if (pipe.err) [[unlikely]] {
+		discardDst();
+		std::rethrow_exception(pipe.err);
+	}
+	if (cancelled) {
+		discardDst();
+		return false;
+	}
+
+	if (options.unbuffered) {
+		try {
+			fout.setSize(copied); // drop the padding of the last block
+		} catch (...) {
+			discardDst();
+			throw;
+		}
+	}
+	if (options.onProgress)
+		options.onProgress(copied, total);
+	return true;
+}
+
 void File::EraseAndWrite(std::wstring_view path, std::span<BYTE> contents)
 {
 	File f{path, Access::OpenOrCreateRW};
@@ -144,14 +410,17 @@ void File::EraseAndWriteStr(std::wstring_view path, std::wstring_view contents)
 	EraseAndWrite(path, raw);
 }
 
-void File::EraseAndWriteLines(std::wstring_view path, std::vector<std::wstring> lines, std::wstring_view br)
+void File::EraseAndWriteLines(std::wstring_view path, const std::vector<std::wstring>& lines, std::wstring_view br)
 {
-	std::wstring joined = str::join(lines, br);
-	joined.append(br); // add final linebreak
-	EraseAndWriteStr(path, joined);
+	FileWriter out{path, false, br};
+	for (const std::wstring& line : lines)
+		out.writeLine(line); // final linebreak included
+	if (lines.empty())
+		out.writeLine(L""); // still a single linebreak, as always
+	out.flush();
 }
 
-
+#ifdef _WIN32
 FileMapped& FileMapped::operator=(FileMapped&& other) noexcept
 {
 	close();
@@ -159,6 +428,8 @@ FileMapped& FileMapped::operator=(FileMapped&& other) noexcept
 	std::swap(_hMap, other._hMap);
 	std::swap(_pMem, other._pMem);
 	std::swap(_sz, other._sz);
+	std::swap(_access, other._access);
+	std::swap(_hint, other._hint);
 	return *this;
 }
 
@@ -176,48 +447,157 @@ void FileMapped::close() noexcept
 	_file.close();
 }
 
-FileMapped& FileMapped::open(std::wstring_view path, Access access)
+FileMapped& FileMapped::open(std::wstring_view path, Access access, bool mapWhole, File::AccessHint hint)
 {
 	close();
+	_access = access;
+	_hint = hint;
 	File::Access facc = (access == Access::ExistingReadOnly) ? File::Access::ExistingReadOnly : File::Access::ExistingRW;
 	DWORD page = (access == Access::ExistingReadOnly) ? PAGE_READONLY : PAGE_READWRITE;
 
-	_file.open(path, facc);
+	_file.open(path, facc, hint);
 
 	_hMap = CreateFileMappingW(_file.hFile(), nullptr, page, 0, 0, nullptr);
 	if (!_hMap) [[unlikely]] {
 		throw std::system_error(GetLastError(), std::system_category(), "CreateFileMapping failed");
 	}
 
-	_pMem = MapViewOfFile(_hMap, FILE_MAP_READ | (access == Access::ExistingRW ? FILE_MAP_WRITE : 0), 0, 0, 0);
-	if (!_pMem) [[unlikely]] {
+	_sz = _file.size();
+	if (mapWhole)
+		_pMem = _mapRange(0, 0); // zero maps up to the end of file
+	return *this;
+}
+
+size_t FileMapped::_Granularity()
+{
+	static size_t granularity = []() -> size_t {
+		SYSTEM_INFO si{};
+		GetSystemInfo(&si);
+		return si.dwAllocationGranularity;
+	}();
+	return granularity;
+}
+
+LPVOID FileMapped::_mapRange(size_t alignedOffset, size_t length) const
+{
+	auto off = static_cast<UINT64>(alignedOffset);
+	LPVOID p = MapViewOfFile(_hMap, FILE_MAP_READ | (_access == Access::ExistingRW ? FILE_MAP_WRITE : 0),
+		static_cast<DWORD>(off >> 32), static_cast<DWORD>(off), length);
+	if (!p) [[unlikely]] {
 		throw std::system_error(GetLastError(), std::system_category(), "MapViewOfFile failed");
 	}
+	return p;
+}
 
-	_sz = _file.size();
-	return *this;
+void FileMapped::_Prefetch(LPVOID p, size_t length) noexcept
+{
+	if (!length) return;
+	WIN32_MEMORY_RANGE_ENTRY range{.VirtualAddress = p, .NumberOfBytes = length};
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0); // just a hint, failure is harmless
 }
+#endif
 
-constexpr const std::span<BYTE> FileMapped::asSpan() const
+const std::span<BYTE> FileMapped::asSpan() const
 {
-	return std::span{reinterpret_cast<BYTE*>(_pMem), size()};
+	return std::span{reinterpret_cast<BYTE*>(_pMem), _pMem ? size() : 0};
 }
 
 std::span<BYTE> FileMapped::asSpan()
 {
-	return std::span{reinterpret_cast<BYTE*>(_pMem), size()};
+	return std::span{reinterpret_cast<BYTE*>(_pMem), _pMem ? size() : 0};
 }
 
+const FileMapped& FileMapped::forEachWindow(size_t windowSize, size_t overlap,
+	std::function<void(std::span<BYTE>, size_t)> callback) const
+{
+	if (overlap >= windowSize) [[unlikely]] {
+		throw std::invalid_argument("Window overlap must be smaller than the window size.");
+	}
+
+	size_t step = windowSize - overlap;
+	bool readAhead = (_hint == File::AccessHint::Sequential);
+	View next;
+
+	for (size_t offset = 0; offset < _sz; offset += step) {
+		bool isLast = (offset + windowSize >= _sz); // this window reaches the end of file
+		if (_pMem) { // whole file already mapped, no need to map each window
+			if (readAhead && !isLast)
+				prefetch(offset + step, windowSize);
+			callback(asSpan().subspan(offset, std::min(windowSize, _sz - offset)), offset);
+		} else {
+			View win = next.size() ? std::move(next) : view(offset, windowSize);
+			if (readAhead && !isLast) {
+				next = view(offset + step, windowSize);
+				next.prefetch();
+			}
+			callback(win.asSpan(), offset);
+		}
+		if (isLast) break;
+	}
+	return *this;
+}
+
+const FileMapped& FileMapped::prefetch(size_t offset, size_t length) const
+{
+	if (!_pMem) [[unlikely]] {
+		throw std::logic_error("FileMapped::prefetch() needs the whole file mapped, use View::prefetch() instead.");
+	}
+	if (offset < _sz)
+		_Prefetch(reinterpret_cast<BYTE*>(_pMem) + offset, std::min(length, _sz - offset));
+	return *this;
+}
+
+FileMapped::View FileMapped::view(size_t offset, size_t length) const
+{
+	if (offset > _sz) [[unlikely]] {
+		throw std::out_of_range("View offset past the end of file.");
+	}
+
+	View v;
+	v._offset = offset;
+	v._sz = std::min(length, _sz - offset);
+	if (v._sz) {
+		size_t misalign = offset % _Granularity(); // mappings must start at an aligned offset
+		v._baseSz = misalign + v._sz;
+		v._pBase = _mapRange(offset - misalign, v._baseSz);
+		v._pData = reinterpret_cast<BYTE*>(v._pBase) + misalign;
+	}
+	return v;
+}
+
+FileMapped::View& FileMapped::View::operator=(View&& other) noexcept
+{
+	close();
+	std::swap(_pBase, other._pBase);
+	std::swap(_baseSz, other._baseSz);
+	std::swap(_pData, other._pData);
+	std::swap(_offset, other._offset);
+	std::swap(_sz, other._sz);
+	return *this;
+}
+
+#ifdef _WIN32
+void FileMapped::View::close() noexcept
+{
+	if (_pBase) {
+		UnmapViewOfFile(_pBase);
+		_pBase = nullptr;
+	}
+	_baseSz = _offset = _sz = 0;
+	_pData = nullptr;
+}
+#endif
+
 std::vector<BYTE> FileMapped::ReadAll(std::wstring_view path)
 {
-	FileMapped f{path, Access::ExistingReadOnly};
+	FileMapped f{path, Access::ExistingReadOnly, true, File::AccessHint::Sequential};
 	std::span<BYTE> raw = f.asSpan();
 	return {raw.begin(), raw.end()};
 }
 
 std::wstring FileMapped::ReadAllStr(std::wstring_view path)
 {
-	FileMapped f{path, Access::ExistingReadOnly};
+	FileMapped f{path, Access::ExistingReadOnly, true, File::AccessHint::Sequential};
 	return str::parse(f.asSpan());
 }
 
@@ -226,3 +606,188 @@ std::vector<std::wstring> FileMapped::ReadAllLines(std::wstring_view path)
 	std::wstring contents = ReadAllStr(path);
 	return str::splitLines(contents);
 }
+
+
+FileMappedWriter& FileMappedWriter::operator=(FileMappedWriter&& other) noexcept
+{
+	close();
+	std::swap(_file, other._file);
+#ifdef _WIN32
+	std::swap(_hMap, other._hMap);
+#endif
+	std::swap(_pMem, other._pMem);
+	std::swap(_capacity, other._capacity);
+	std::swap(_len, other._len);
+	return *this;
+}
+
+FileMappedWriter& FileMappedWriter::advance(size_t numBytes)
+{
+	if (numBytes > _capacity - _len) [[unlikely]] {
+		throw std::out_of_range("Advancing past the reserved space.");
+	}
+	_len += numBytes;
+	return *this;
+}
+
+void FileMappedWriter::close() noexcept
+{
+	_unmap();
+	if (_capacity) {
+		try {
+			_file.setSize(_len); // drop the unused mapped space
+		} catch (...) { } // can't throw from the destructor, at worst the file has trailing zeros
+	}
+	_file.close();
+	_capacity = _len = 0;
+}
+
+FileMappedWriter& FileMappedWriter::open(std::wstring_view path, size_t initialSize)
+{
+	close();
+	_file.open(path, File::Access::OpenOrCreateRW);
+	try {
+		size_t capacity = std::max(initialSize, size_t{1}); // an empty file can't be mapped
+		_file.setSize(capacity);
+		_capacity = capacity;
+		_map();
+	} catch (...) {
+		close(); // so a later write() doesn't go through a null mapping
+		throw;
+	}
+	return *this;
+}
+
+std::span<BYTE> FileMappedWriter::reserve(size_t numBytes)
+{
+	if (numBytes > _capacity - _len)
+		_grow(_len + numBytes);
+	return std::span{_pMem + _len, numBytes};
+}
+
+FileMappedWriter& FileMappedWriter::write(std::span<const BYTE> data)
+{
+	std::copy(data.begin(), data.end(), reserve(data.size()).begin());
+	_len += data.size();
+	return *this;
+}
+
+void FileMappedWriter::_grow(size_t minCapacity)
+{
+	size_t newCapacity = std::max(minCapacity, _capacity * 2); // geometric growth, so remaps are rare
+	_unmap();
+	try {
+		_file.setSize(newCapacity);
+		_capacity = newCapacity; // only now, _unmap() must know the mapped size
+		_map();
+	} catch (...) {
+		close(); // the old mapping is gone; keep the bytes written so far, and stop accepting writes
+		throw;
+	}
+}
+
+#ifdef _WIN32
+void FileMappedWriter::_map()
+{
+	auto cap = static_cast<UINT64>(_capacity);
+	_hMap = CreateFileMappingW(_file.hFile(), nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(cap >> 32), static_cast<DWORD>(cap), nullptr);
+	if (!_hMap) [[unlikely]] {
+		throw std::system_error(GetLastError(), std::system_category(), "CreateFileMapping failed");
+	}
+
+	_pMem = reinterpret_cast<BYTE*>(MapViewOfFile(_hMap, FILE_MAP_WRITE, 0, 0, _capacity));
+	if (!_pMem) [[unlikely]] {
+		throw std::system_error(GetLastError(), std::system_category(), "MapViewOfFile failed");
+	}
+}
+
+void FileMappedWriter::_unmap() noexcept
+{
+	if (_pMem) {
+		UnmapViewOfFile(_pMem);
+		_pMem = nullptr;
+	}
+	if (_hMap) { // the file can't be resized while the mapping exists
+		CloseHandle(_hMap);
+		_hMap = nullptr;
+	}
+}
+#endif
+
+
+FileWriter& FileWriter::operator=(FileWriter&& other) noexcept
+{
+	close();
+	std::swap(_file, other._file);
+	std::swap(_buf, other._buf);
+	std::swap(_len, other._len);
+	std::swap(_br, other._br);
+	return *this;
+}
+
+void FileWriter::close() noexcept
+{
+	try {
+		flush();
+	} catch (...) { } // can't throw from the destructor
+	_len = 0; // if flush() failed, so the bytes don't end up in the next open() file
+	_file.close();
+}
+
+FileWriter& FileWriter::flush()
+{
+	if (_len) {
+		_file.write(std::span{_buf.data(), _len});
+		_len = 0;
+	}
+	return *this;
+}
+
+FileWriter& FileWriter::open(std::wstring_view path, bool writeBom, std::wstring_view br, size_t bufferSize)
+{
+	close();
+	_file.open(path, File::Access::OpenOrCreateRW);
+	_file.setSize(0);
+	_buf.resize(std::max(bufferSize, size_t{64})); // room for a few chars at least
+	_br = br;
+
+	if (writeBom) {
+		constexpr BYTE utf8bom[] = {0xef, 0xbb, 0xbf};
+		write(utf8bom);
+	}
+	return *this;
+}
+
+FileWriter& FileWriter::write(std::span<const BYTE> data)
+{
+	if (data.size() > _buf.size() - _len)
+		flush();
+	if (data.size() >= _buf.size()) { // too big to be buffered
+		_file.write(data);
+	} else {
+		std::copy(data.begin(), data.end(), _buf.begin() + _len);
+		_len += data.size();
+	}
+	return *this;
+}
+
+FileWriter& FileWriter::writeStr(std::wstring_view s)
+{
+	constexpr size_t MAX_UTF8_LEN = 4; // bytes per char, worst case
+	while (!s.empty()) {
+		size_t numChars = std::min(s.length(), (_buf.size() - _len) / MAX_UTF8_LEN);
+		if (numChars && numChars < s.length() && s[numChars - 1] >= 0xd800 && s[numChars - 1] <= 0xdbff)
+			--numChars; // don't split a surrogate pair
+		if (!numChars) {
+			if (!_len) [[unlikely]] {
+				throw std::logic_error("FileWriter is not open.");
+			}
+			flush();
+			continue;
+		}
+		_len += str::toUtf8(s.substr(0, numChars), std::span{_buf}.subspan(_len));
+		s.remove_prefix(numChars);
+	}
+	return *this;
+}
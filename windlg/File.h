@@ -1,17 +1,39 @@
 #pragma once
+#include <functional>
 #include <span>
+#include <stop_token>
+#include <string>
 #include <string_view>
 #include <vector>
-#include <Windows.h>
+#include "sys.h"
 
 namespace lib {
 
-// Manages a file HANDLE.
+// Manages a file HANDLE, or a file descriptor on POSIX.
 class File final {
 public:
+	// Default number of bytes transferred by each system call in chunked operations.
+	static constexpr size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
 	// Requested access to open/create a file.
 	enum class Access { ExistingReadOnly, ExistingRW, OpenOrCreateRW, CreateRW };
 
+	// Expected access pattern, so the system can tune caching and read-ahead.
+	// WriteThrough makes each write reach the disk before returning. Unbuffered
+	// bypasses the system cache, so the buffers, offsets and sizes of all reads and
+	// writes must be multiples of the sector size.
+	enum class AccessHint { Normal, Sequential, Random, WriteThrough, Unbuffered };
+
+	// Options of Copy().
+	struct CopyOptions final {
+		size_t bufferSize = CHUNK_SIZE; // bytes transferred by each read and write
+		size_t numBuffers = 3; // reads run ahead of the writes by up to numBuffers - 1 buffers
+		bool unbuffered = false; // writes bypass the system cache, so huge copies don't flush it
+		UINT progressIntervalMs = 100; // minimum interval between onProgress calls
+		std::function<void(size_t copied, size_t total)> onProgress; // called on the calling thread
+		std::stop_token stopToken; // cancels the copy when a stop is requested
+	};
+
 	// Returned by times().
 	struct Times final {
 		SYSTEMTIME creation{}, lastAccess{}, lastWrite{};
@@ -25,27 +47,79 @@ public:
 	File& operator=(const File&) = delete;
 	File& operator=(File&& other) noexcept;
 
+#ifdef _WIN32
 	constexpr explicit File(HANDLE hFile) : _hFile{hFile} { }
-	File(std::wstring_view path, Access access) { open(path, access); }
+#else
+	constexpr explicit File(int fd) : _fd{fd} { }
+#endif
+	File(std::wstring_view path, Access access, AccessHint hint = AccessHint::Normal) { open(path, access, hint); }
 
 	void close() noexcept;
+#ifdef _WIN32
 	[[nodiscard]] constexpr HANDLE hFile() const { return _hFile; }
-	File& open(std::wstring_view path, Access access);
+#else
+	[[nodiscard]] constexpr int fd() const { return _fd; }
+#endif
+	File& open(std::wstring_view path, Access access, AccessHint hint = AccessHint::Normal) { return _open(path, access, hint, false); }
 	[[nodiscard]] size_t pointerOffset() const;
+	// Reads from the current pointer until dest is full or the file ends, in
+	// blocks of blockSize bytes. Returns the number of bytes actually read.
+	[[nodiscard]] size_t read(std::span<BYTE> dest, size_t blockSize = CHUNK_SIZE) const;
+
 	[[nodiscard]] std::vector<BYTE> readAll() const;
-	const File& readBuffer(std::vector<BYTE>& buffer) const;
+
+	// Reads from the current pointer until buffer is full or the file ends, in
+	// blocks of blockSize bytes; buffer is then resized to the bytes actually read.
+	const File& readBuffer(std::vector<BYTE>& buffer, size_t blockSize = CHUNK_SIZE) const;
+
+	// Reads from the current pointer until the file ends, calling the callback on each
+	// block. A single buffer is reused, so files larger than memory can be processed.
+	// Throws std::invalid_argument if blockSize is zero.
+	const File& readChunks(size_t blockSize, std::function<void(std::span<BYTE>)> callback) const;
+
+	// Reads from the current pointer into each buffer in turn, until all are full or
+	// the file ends. Returns the number of bytes actually read.
+	[[nodiscard]] size_t readV(std::span<const std::span<BYTE>> buffers) const;
+
 	const File& setPointerOffset(size_t offset) const;
 	const File& setSize(size_t newSizeBytes) const;
 	[[nodiscard]] size_t size() const;
 	[[nodiscard]] Times times() const;
-	const File& write(std::span<BYTE> data) const;
+	const File& write(std::span<const BYTE> data) const;
+	// Writes all buffers at the current pointer, as if they were concatenated, without
+	// one system call per buffer.
+	const File& writeV(std::span<const std::span<const BYTE>> buffers) const;
 
+	// Copies src to dst, overwriting it, with a second thread reading ahead while
+	// the calling thread writes. Returns false if cancelled; if cancelled or failed,
+	// dst is deleted. Throws std::invalid_argument if both are the same file.
+	// Example:
+	// std::jthread worker{[&](std::stop_token st) {
+	//     File::Copy(L"C:\\Temp\\big.iso", L"D:\\big.iso", {
+	//         .onProgress = [&](size_t copied, size_t total) {
+	//             auto pct = static_cast<UINT>(total ? copied * 100 / total : 100);
+	//             postUiThread([=, this]() { progressBar.setPos(pct); });
+	//         },
+	//         .stopToken = st,
+	//     });
+	// }};
+	static bool Copy(std::wstring_view src, std::wstring_view dst, const CopyOptions& options);
+	static bool Copy(std::wstring_view src, std::wstring_view dst) { return Copy(src, dst, CopyOptions{}); }
 	static void EraseAndWrite(std::wstring_view path, std::span<BYTE> contents);
 	static void EraseAndWriteStr(std::wstring_view path, std::wstring_view contents);
-	static void EraseAndWriteLines(std::wstring_view path, std::vector<std::wstring> lines, std::wstring_view br = L"\r\n");
+	static void EraseAndWriteLines(std::wstring_view path, const std::vector<std::wstring>& lines, std::wstring_view br = L"\r\n");
 
 private:
+	friend class AsyncFile;
+	File& _open(std::wstring_view path, Access access, AccessHint hint, bool overlapped);
+	static void _Remove(std::wstring_view path) noexcept;
+	[[nodiscard]] static bool _SameFile(const File& a, const File& b);
+
+#ifdef _WIN32
 	HANDLE _hFile = nullptr;
+#else
+	int _fd = -1;
+#endif
 };
 
 
@@ -54,6 +128,39 @@ class FileMapped final {
 public:
 	enum class Access { ExistingReadOnly, ExistingRW };
 
+	// Mapped range of the file, returned by view(). Stays valid even after the
+	// FileMapped is closed.
+	class View final {
+	public:
+		~View() { close(); }
+
+		constexpr View() = default;
+		View(const View&) = delete;
+		View(View&& other) noexcept { operator=(std::forward<View>(other)); }
+		View& operator=(const View&) = delete;
+		View& operator=(View&& other) noexcept;
+
+		[[nodiscard]] const BYTE& operator[](size_t index) const { return _pData[index]; }
+		[[nodiscard]] BYTE& operator[](size_t index) { return _pData[index]; }
+
+		void close() noexcept;
+		// Offset of the first byte of the view within the file.
+		[[nodiscard]] constexpr size_t offset() const { return _offset; }
+		[[nodiscard]] constexpr size_t size() const { return _sz; }
+		[[nodiscard]] const std::span<BYTE> asSpan() const { return std::span{_pData, _sz}; }
+		[[nodiscard]] std::span<BYTE> asSpan() { return std::span{_pData, _sz}; }
+		// Asks the system to start reading the whole view into memory, without waiting.
+		const View& prefetch() const { _Prefetch(_pData, _sz); return *this; }
+
+	private:
+		friend FileMapped;
+		LPVOID _pBase = nullptr; // the mapping starts at an aligned offset, before _pData
+		size_t _baseSz = 0;
+		BYTE* _pData = nullptr;
+		size_t _offset = 0;
+		size_t _sz = 0;
+	};
+
 	~FileMapped() { close(); }
 
 	constexpr FileMapped() = default;
@@ -62,27 +169,159 @@ public:
 	FileMapped& operator=(const FileMapped&) = delete;
 	FileMapped& operator=(FileMapped&& other) noexcept;
 
-	FileMapped(std::wstring_view path, Access access) { open(path, access); }
+	FileMapped(std::wstring_view path, Access access, bool mapWhole = true, File::AccessHint hint = File::AccessHint::Normal)
+	{
+		open(path, access, mapWhole, hint);
+	}
 
 	[[nodiscard]] const BYTE& operator[](size_t index) const { return reinterpret_cast<BYTE*>(_pMem)[index]; }
 	[[nodiscard]] BYTE& operator[](size_t index) { return reinterpret_cast<BYTE*>(_pMem)[index]; }
 
 	void close() noexcept;
-	FileMapped& open(std::wstring_view path, Access access);
+	// If mapWhole is false, nothing is mapped until view() or forEachWindow() is
+	// called, so huge files can be processed with a bounded mapped region.
+	FileMapped& open(std::wstring_view path, Access access, bool mapWhole = true,
+		File::AccessHint hint = File::AccessHint::Normal);
 	[[nodiscard]] constexpr size_t size() const { return _sz; }
-	[[nodiscard]] constexpr const std::span<BYTE> asSpan() const;
+	[[nodiscard]] const std::span<BYTE> asSpan() const;
 	[[nodiscard]] std::span<BYTE> asSpan();
 	[[nodiscard]] constexpr const File& file() const { return _file; }
 
+	// Calls the callback on consecutive windows of windowSize bytes, each one sharing
+	// overlap bytes with the previous, so matches across window boundaries aren't
+	// missed. Only one window is mapped at a time; with the Sequential hint, the
+	// next one is also mapped and prefetched while the callback runs.
+	const FileMapped& forEachWindow(size_t windowSize, size_t overlap,
+		std::function<void(std::span<BYTE> window, size_t offset)> callback) const;
+
+	// Asks the system to start reading the range into memory, without waiting, so
+	// a cold scan doesn't stall on each page fault. The whole file must be mapped.
+	const FileMapped& prefetch(size_t offset, size_t length) const;
+
+	// Maps length bytes starting at offset, clamped to the end of the file. The offset
+	// doesn't need to be aligned.
+	[[nodiscard]] View view(size_t offset, size_t length) const;
+
 	[[nodiscard]] static std::vector<BYTE> ReadAll(std::wstring_view path);
 	[[nodiscard]] static std::wstring ReadAllStr(std::wstring_view path);
 	[[nodiscard]] static std::vector<std::wstring> ReadAllLines(std::wstring_view path);
 
 private:
+	[[nodiscard]] static size_t _Granularity();
+	[[nodiscard]] LPVOID _mapRange(size_t alignedOffset, size_t length) const;
+	static void _Prefetch(LPVOID p, size_t length) noexcept;
+
 	File _file;
+#ifdef _WIN32
 	HANDLE _hMap = nullptr;
+#endif
 	LPVOID _pMem = nullptr;
 	size_t _sz = 0;
+	Access _access = Access::ExistingReadOnly;
+	File::AccessHint _hint = File::AccessHint::Normal;
+};
+
+
+// Writes a file through a memory mapping, which grows geometrically as data is
+// appended. On close, the file is truncated to the bytes actually written.
+// Example:
+// FileMappedWriter out{L"C:\\Temp\\export.csv"};
+// for (const auto& row : rows)
+//     out.write(str::toUtf8Blob(row));
+// out.close();
+class FileMappedWriter final {
+public:
+	// Default number of bytes mapped when the file is created.
+	static constexpr size_t INITIAL_SIZE = 1024 * 1024;
+
+	~FileMappedWriter() { close(); }
+
+	constexpr FileMappedWriter() = default;
+	FileMappedWriter(const FileMappedWriter&) = delete;
+	FileMappedWriter(FileMappedWriter&& other) noexcept { operator=(std::forward<FileMappedWriter>(other)); }
+	FileMappedWriter& operator=(const FileMappedWriter&) = delete;
+	FileMappedWriter& operator=(FileMappedWriter&& other) noexcept;
+
+	FileMappedWriter(std::wstring_view path, size_t initialSize = INITIAL_SIZE) { open(path, initialSize); }
+
+	// Commits numBytes written into the span returned by reserve().
+	FileMappedWriter& advance(size_t numBytes);
+	// Truncates the file to the bytes written, and closes it.
+	void close() noexcept;
+	// Creates the file, or overwrites an existing one, mapping initialSize bytes.
+	FileMappedWriter& open(std::wstring_view path, size_t initialSize = INITIAL_SIZE);
+	// Returns room for numBytes at the end of the written data, growing the mapping
+	// if needed, so data can be formatted in place; then call advance(). The span
+	// is invalidated by the next reserve() or write(). If growing fails, the file
+	// is closed with the bytes written so far, and the error is thrown.
+	[[nodiscard]] std::span<BYTE> reserve(size_t numBytes);
+	// Number of bytes written so far.
+	[[nodiscard]] constexpr size_t size() const { return _len; }
+	// Appends the data, growing the mapping if needed, like reserve().
+	FileMappedWriter& write(std::span<const BYTE> data);
+
+private:
+	void _grow(size_t minCapacity);
+	void _map();
+	void _unmap() noexcept;
+
+	File _file;
+#ifdef _WIN32
+	HANDLE _hMap = nullptr;
+#endif
+	BYTE* _pMem = nullptr;
+	size_t _capacity = 0; // mapped bytes, which is also the file size until close()
+	size_t _len = 0;
+};
+
+
+// Buffered file writer, which encodes text as UTF-8 directly into a reusable
+// buffer and writes it when full, so large outputs take constant memory.
+// Example:
+// FileWriter out{L"C:\\Temp\\export.csv"};
+// for (const auto& row : rows)
+//     out.writeLine(row);
+// out.flush();
+class FileWriter final {
+public:
+	// Default size of the buffer.
+	static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+
+	~FileWriter() { close(); }
+
+	constexpr FileWriter() = default;
+	FileWriter(const FileWriter&) = delete;
+	FileWriter(FileWriter&& other) noexcept { operator=(std::forward<FileWriter>(other)); }
+	FileWriter& operator=(const FileWriter&) = delete;
+	FileWriter& operator=(FileWriter&& other) noexcept;
+
+	FileWriter(std::wstring_view path, bool writeBom = false,
+		std::wstring_view br = L"\r\n", size_t bufferSize = BUFFER_SIZE)
+	{
+		open(path, writeBom, br, bufferSize);
+	}
+
+	// Writes any buffered data and closes the file. Errors are ignored, so call
+	// flush() before, if they matter.
+	void close() noexcept;
+	// Writes the buffered data to the file.
+	FileWriter& flush();
+	// Creates the file, or erases an existing one. The line break br is appended
+	// by writeLine().
+	FileWriter& open(std::wstring_view path, bool writeBom = false,
+		std::wstring_view br = L"\r\n", size_t bufferSize = BUFFER_SIZE);
+	// Appends raw bytes.
+	FileWriter& write(std::span<const BYTE> data);
+	// Appends the string followed by the line break, encoded as UTF-8.
+	FileWriter& writeLine(std::wstring_view s) { return writeStr(s).writeStr(_br); }
+	// Appends the string, encoded as UTF-8.
+	FileWriter& writeStr(std::wstring_view s);
+
+private:
+	File _file;
+	std::vector<BYTE> _buf; // kept between open() calls
+	size_t _len = 0;
+	std::wstring _br;
 };
 
 }
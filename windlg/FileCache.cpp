@@ -0,0 +1,177 @@
+#include <system_error>
+#include "File.h"
+#include "FileCache.h"
+#include "str.h"
+using namespace lib;
+
+#ifdef _WIN32
+// Reads size and last write time from the directory entry, without opening the file.
+static std::pair<UINT64, UINT64> _sysStamp(std::wstring_view path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad{};
+	if (!GetFileAttributesExW(path.data(), GetFileExInfoStandard, &fad)) [[unlikely]] {
+		throw std::system_error(GetLastError(), std::system_category(), "GetFileAttributesEx failed");
+	}
+	return {(UINT64{fad.nFileSizeHigh} << 32) | fad.nFileSizeLow,
+		(UINT64{fad.ftLastWriteTime.dwHighDateTime} << 32) | fad.ftLastWriteTime.dwLowDateTime};
+}
+#else
+#include <cerrno>
+#include <sys/stat.h>
+
+static std::pair<UINT64, UINT64> _sysStamp(std::wstring_view path)
+{
+	struct stat st{};
+	if (stat(str::toUtf8(path).c_str(), &st) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "stat failed");
+	}
+	return {static_cast<UINT64>(st.st_size),
+		static_cast<UINT64>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec};
+}
+#endif
+
+// Prefixes the path with the kind of entry. Windows paths are case-insensitive,
+// so the same file opened as "C:\\x.ini" and "c:\\X.INI" gets a single entry.
+static std::wstring _cacheKey(WCHAR kind, std::wstring_view path)
+{
+	std::wstring key{kind};
+#ifdef _WIN32
+	key.append(str::toUpper(path));
+#else
+	key.append(path);
+#endif
+	return key;
+}
+
+static size_t _strCost(const std::wstring& s)
+{
+	return sizeof(std::wstring) + (s.length() > str::SSO_LEN ? s.capacity() * sizeof(WCHAR) : 0);
+}
+
+FileCache& FileCache::Global()
+{
+	static FileCache cache;
+	return cache;
+}
+
+std::shared_ptr<const std::vector<BYTE>> FileCache::bytes(std::wstring_view path)
+{
+	return std::static_pointer_cast<const std::vector<BYTE>>(
+		_get(Kind::Bytes, path, [](std::wstring_view path) {
+			auto data = std::make_shared<const std::vector<BYTE>>(FileMapped::ReadAll(path));
+			return std::pair{data, data->size()};
+		}));
+}
+
+void FileCache::clear()
+{
+	std::lock_guard lock{_mtx};
+	_entries.clear();
+	_lru.clear();
+	_used = 0;
+}
+
+void FileCache::erase(std::wstring_view path)
+{
+	std::lock_guard lock{_mtx};
+	for (Kind kind : {Kind::Bytes, Kind::Str, Kind::Lines, Kind::IniFile}) {
+		std::wstring key = _cacheKey(static_cast<WCHAR>(kind), path);
+		if (auto it = _entries.find(key); it != _entries.end())
+			_remove(it);
+	}
+}
+
+std::shared_ptr<const Ini> FileCache::ini(std::wstring_view path)
+{
+	return std::static_pointer_cast<const Ini>(
+		_get(Kind::IniFile, path, [](std::wstring_view path) {
+			auto data = std::make_shared<Ini>();
+			data->load(path);
+			size_t cost = sizeof(Ini);
+			for (const Ini::Section& section : data->sections) {
+				cost += sizeof(Ini::Section) + _strCost(section.name);
+				for (const Ini::Section::KeyVal& kv : section.keysVals)
+					cost += _strCost(kv.key) + _strCost(kv.val);
+			}
+			return std::pair{std::shared_ptr<const Ini>{std::move(data)}, cost};
+		}));
+}
+
+std::shared_ptr<const std::vector<std::wstring>> FileCache::lines(std::wstring_view path)
+{
+	return std::static_pointer_cast<const std::vector<std::wstring>>(
+		_get(Kind::Lines, path, [](std::wstring_view path) {
+			auto data = std::make_shared<const std::vector<std::wstring>>(FileMapped::ReadAllLines(path));
+			size_t cost = 0;
+			for (const std::wstring& line : *data)
+				cost += _strCost(line);
+			return std::pair{data, cost};
+		}));
+}
+
+void FileCache::setBudget(size_t budgetBytes)
+{
+	std::lock_guard lock{_mtx};
+	_budget = budgetBytes;
+	_evict();
+}
+
+std::shared_ptr<const std::wstring> FileCache::str(std::wstring_view path)
+{
+	return std::static_pointer_cast<const std::wstring>(
+		_get(Kind::Str, path, [](std::wstring_view path) {
+			auto data = std::make_shared<const std::wstring>(FileMapped::ReadAllStr(path));
+			return std::pair{data, _strCost(*data)};
+		}));
+}
+
+size_t FileCache::usedBytes() const
+{
+	std::lock_guard lock{_mtx};
+	return _used;
+}
+
+std::shared_ptr<const void> FileCache::_get(Kind kind, std::wstring_view path, const Loader& load)
+{
+	auto [size, lastWrite] = _sysStamp(path); // taken before loading, so a write during the load isn't missed
+	Stamp stamp{.size = size, .lastWrite = lastWrite};
+	std::wstring key = _cacheKey(static_cast<WCHAR>(kind), path);
+
+	{
+		std::lock_guard lock{_mtx};
+		if (auto it = _entries.find(key); it != _entries.end()) {
+			if (it->second.stamp == stamp) {
+				_lru.splice(_lru.begin(), _lru, it->second.lruPos); // now the most recently used
+				return it->second.data;
+			}
+			_remove(it); // stale
+		}
+	}
+
+	auto [data, cost] = load(path); // not under the lock, other files can be served meanwhile
+	cost += sizeof(Entry) + key.length() * sizeof(WCHAR);
+
+	std::lock_guard lock{_mtx};
+	if (cost > _budget) return data; // would evict everything else
+	if (auto it = _entries.find(key); it != _entries.end())
+		_remove(it); // loaded concurrently by another thread
+	auto [it, _] = _entries.emplace(std::move(key), Entry{.stamp = stamp, .data = data, .cost = cost});
+	_lru.push_front(&it->first);
+	it->second.lruPos = _lru.begin();
+	_used += cost;
+	_evict();
+	return data;
+}
+
+void FileCache::_evict()
+{
+	while (_used > _budget && !_lru.empty())
+		_remove(_entries.find(*_lru.back()));
+}
+
+void FileCache::_remove(std::unordered_map<std::wstring, Entry>::iterator it)
+{
+	_used -= it->second.cost;
+	_lru.erase(it->second.lruPos);
+	_entries.erase(it);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ini.h"
+#include "sys.h"
+
+namespace lib {
+
+// LRU cache of file contents, decoded once and shared as immutable objects, within
+// a memory budget. Each hit costs a single attribute query, and the file is loaded
+// again if its size or last write time changed. Safe to use from any thread.
+// Example:
+// std::shared_ptr<const Ini> ini = FileCache::Global().ini(L"C:\\Temp\\foo.ini");
+// const std::wstring& name = ini->get(L"General", L"Name");
+class FileCache final {
+public:
+	// Default memory budget of the process-wide cache.
+	static constexpr size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+	FileCache(const FileCache&) = delete;
+	FileCache(FileCache&&) = delete;
+	FileCache& operator=(const FileCache&) = delete;
+	FileCache& operator=(FileCache&&) = delete;
+
+	explicit FileCache(size_t budgetBytes = DEFAULT_BUDGET) : _budget{budgetBytes} { }
+
+	// Returns the process-wide cache.
+	[[nodiscard]] static FileCache& Global();
+
+	// Returns the raw contents, like FileMapped::ReadAll().
+	[[nodiscard]] std::shared_ptr<const std::vector<BYTE>> bytes(std::wstring_view path);
+	// Drops all entries.
+	void clear();
+	// Drops all entries of the file, if any.
+	void erase(std::wstring_view path);
+	// Returns the parsed file, like Ini::load().
+	[[nodiscard]] std::shared_ptr<const Ini> ini(std::wstring_view path);
+	// Returns the decoded lines, like FileMapped::ReadAllLines().
+	[[nodiscard]] std::shared_ptr<const std::vector<std::wstring>> lines(std::wstring_view path);
+	// Sets the memory budget, evicting the least recently used entries if needed.
+	void setBudget(size_t budgetBytes);
+	// Returns the decoded text, like FileMapped::ReadAllStr().
+	[[nodiscard]] std::shared_ptr<const std::wstring> str(std::wstring_view path);
+	// Approximate number of bytes held by all entries.
+	[[nodiscard]] size_t usedBytes() const;
+
+private:
+	// The same file can be cached in different forms, each one an entry.
+	enum class Kind : WCHAR { Bytes = L'b', Str = L's', Lines = L'l', IniFile = L'i' };
+
+	// Identifies the version of the file, as stored in its directory entry.
+	struct Stamp final {
+		UINT64 size = 0;
+		UINT64 lastWrite = 0;
+
+		[[nodiscard]] bool operator==(const Stamp&) const = default;
+	};
+
+	struct Entry final {
+		Stamp stamp;
+		std::shared_ptr<const void> data;
+		size_t cost = 0; // approximate bytes held by data
+		std::list<const std::wstring*>::iterator lruPos{};
+	};
+
+	// Loads the file, returning the data and its cost.
+	using Loader = std::function<std::pair<std::shared_ptr<const void>, size_t>(std::wstring_view path)>;
+
+	[[nodiscard]] std::shared_ptr<const void> _get(Kind kind, std::wstring_view path, const Loader& load);
+	void _evict();
+	void _remove(std::unordered_map<std::wstring, Entry>::iterator it);
+
+	mutable std::mutex _mtx;
+	std::unordered_map<std::wstring, Entry> _entries; // keyed by kind + path, uppercase on Windows
+	std::list<const std::wstring*> _lru; // keys of _entries, most recently used first
+	size_t _budget;
+	size_t _used = 0;
+};
+
+}
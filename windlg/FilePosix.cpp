@@ -0,0 +1,333 @@
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "File.h"
+#include "str.h"
+using namespace lib;
+
+// POSIX backend of File, FileMapped and FileMappedWriter; the Win32 one is in File.cpp.
+
+// Fills iov with the buffers not yet transferred, skipping the first skip bytes
+// of the first one; at most IOV_MAX entries, the limit of readv() and writev().
+template<typename B>
+static void _fillIovecs(std::span<const std::span<B>> buffers, size_t skip, std::vector<iovec>& iov)
+{
+	iov.clear();
+	for (const auto& buf : buffers) {
+		if (iov.size() == IOV_MAX) break;
+		if (buf.size() > skip)
+			iov.push_back({.iov_base = const_cast<BYTE*>(buf.data()) + skip, .iov_len = buf.size() - skip});
+		skip = 0;
+	}
+}
+
+// Advances past numBytes transferred, returning the index of the first buffer not
+// fully transferred; skip receives the bytes of it already transferred.
+template<typename B>
+static size_t _advanceIovecs(std::span<const std::span<B>> buffers, size_t idx, size_t& skip, size_t numBytes)
+{
+	numBytes += skip;
+	while (idx < buffers.size() && numBytes >= buffers[idx].size())
+		numBytes -= buffers[idx++].size();
+	skip = numBytes;
+	return idx;
+}
+
+File& File::operator=(File&& other) noexcept
+{
+	close();
+	std::swap(_fd, other._fd);
+	return *this;
+}
+
+void File::close() noexcept
+{
+	if (_fd != -1) {
+		::close(_fd);
+		_fd = -1;
+	}
+}
+
+File& File::_open(std::wstring_view path, Access access, AccessHint hint, bool)
+{
+	close();
+	int flags = 0;
+
+	switch (access) {
+	case Access::ExistingReadOnly:
+		flags = O_RDONLY;
+		break;
+	case Access::ExistingRW:
+		flags = O_RDWR;
+		break;
+	case Access::OpenOrCreateRW:
+		flags = O_RDWR | O_CREAT;
+		break;
+	case Access::CreateRW:
+		flags = O_RDWR | O_CREAT | O_EXCL;
+	}
+	if (hint == AccessHint::WriteThrough)
+		flags |= O_DSYNC;
+
+	_fd = ::open(str::toUtf8(path).c_str(), flags | O_CLOEXEC, 0666);
+	if (_fd == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "open failed");
+	}
+
+	if (hint == AccessHint::Unbuffered) { // fails on filesystems without direct I/O, like tmpfs, which is harmless
+#ifdef O_DIRECT
+		fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_DIRECT);
+#elif defined(F_NOCACHE)
+		fcntl(_fd, F_NOCACHE, 1); // macOS
+#endif
+	}
+
+	if (hint == AccessHint::Sequential || hint == AccessHint::Random) // just a hint, failure is harmless
+		posix_fadvise(_fd, 0, 0, hint == AccessHint::Sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+	return *this;
+}
+
+size_t File::pointerOffset() const
+{
+	off_t curOffset = lseek(_fd, 0, SEEK_CUR);
+	if (curOffset == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "lseek failed");
+	}
+	return static_cast<size_t>(curOffset);
+}
+
+size_t File::read(std::span<BYTE> dest, size_t blockSize) const
+{
+	size_t totalRead = 0;
+	while (totalRead < dest.size()) {
+		size_t toRead = std::min(dest.size() - totalRead, blockSize);
+		ssize_t numRead = ::read(_fd, dest.data() + totalRead, toRead);
+		if (numRead == -1) [[unlikely]] {
+			if (errno == EINTR) continue; // interrupted by a signal, try again
+			throw std::system_error(errno, std::generic_category(), "read failed");
+		}
+		if (!numRead) break; // end of file
+		totalRead += numRead;
+	}
+	return totalRead;
+}
+
+size_t File::readV(std::span<const std::span<BYTE>> buffers) const
+{
+	std::vector<iovec> iov;
+	size_t idx = 0, skip = 0, totalRead = 0;
+	for (;;) {
+		_fillIovecs(buffers.subspan(idx), skip, iov);
+		if (iov.empty()) break; // all buffers are full
+
+		ssize_t numRead = ::readv(_fd, iov.data(), static_cast<int>(iov.size()));
+		if (numRead == -1) [[unlikely]] {
+			if (errno == EINTR) continue; // interrupted by a signal, try again
+			throw std::system_error(errno, std::generic_category(), "readv failed");
+		}
+		if (!numRead) break; // end of file
+		totalRead += numRead;
+		idx = _advanceIovecs(buffers, idx, skip, numRead);
+	}
+	return totalRead;
+}
+
+const File& File::setPointerOffset(size_t offset) const
+{
+	if (lseek(_fd, static_cast<off_t>(offset), SEEK_SET) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "lseek failed");
+	}
+	return *this;
+}
+
+const File& File::setSize(size_t newSizeBytes) const
+{
+	if (ftruncate(_fd, static_cast<off_t>(newSizeBytes)) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "ftruncate failed");
+	}
+	return setPointerOffset(newSizeBytes); // like SetEndOfFile()
+}
+
+size_t File::size() const
+{
+	struct stat st{};
+	if (fstat(_fd, &st) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "fstat failed");
+	}
+	return static_cast<size_t>(st.st_size);
+}
+
+static SYSTEMTIME _localTime(const timespec& ts)
+{
+	tm t{};
+	localtime_r(&ts.tv_sec, &t);
+	return {
+		.wYear = static_cast<WORD>(t.tm_year + 1900),
+		.wMonth = static_cast<WORD>(t.tm_mon + 1),
+		.wDayOfWeek = static_cast<WORD>(t.tm_wday),
+		.wDay = static_cast<WORD>(t.tm_mday),
+		.wHour = static_cast<WORD>(t.tm_hour),
+		.wMinute = static_cast<WORD>(t.tm_min),
+		.wSecond = static_cast<WORD>(t.tm_sec),
+		.wMilliseconds = static_cast<WORD>(ts.tv_nsec / 1'000'000),
+	};
+}
+
+File::Times File::times() const
+{
+	struct stat st{};
+	if (fstat(_fd, &st) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "fstat failed");
+	}
+
+	Times ret;
+	ret.creation = _localTime(st.st_ctim); // no creation time on POSIX, status change is the closest
+	ret.lastAccess = _localTime(st.st_atim);
+	ret.lastWrite = _localTime(st.st_mtim);
+	return ret;
+}
+
+const File& File::write(std::span<const BYTE> data) const
+{
+	while (!data.empty()) {
+		ssize_t written = ::write(_fd, data.data(), data.size());
+		if (written == -1) [[unlikely]] {
+			if (errno == EINTR) continue; // interrupted by a signal, try again
+			throw std::system_error(errno, std::generic_category(), "write failed");
+		}
+		data = data.subspan(written);
+	}
+	return *this;
+}
+
+void File::_Remove(std::wstring_view path) noexcept
+{
+	unlink(str::toUtf8(path).c_str());
+}
+
+bool File::_SameFile(const File& a, const File& b)
+{
+	struct stat stA{}, stB{};
+	if (fstat(a._fd, &stA) == -1 || fstat(b._fd, &stB) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "fstat failed");
+	}
+	return stA.st_dev == stB.st_dev && stA.st_ino == stB.st_ino;
+}
+
+const File& File::writeV(std::span<const std::span<const BYTE>> buffers) const
+{
+	std::vector<iovec> iov;
+	size_t idx = 0, skip = 0;
+	for (;;) {
+		_fillIovecs(buffers.subspan(idx), skip, iov);
+		if (iov.empty()) break; // everything written
+
+		ssize_t written = ::writev(_fd, iov.data(), static_cast<int>(iov.size()));
+		if (written == -1) [[unlikely]] {
+			if (errno == EINTR) continue; // interrupted by a signal, try again
+			throw std::system_error(errno, std::generic_category(), "writev failed");
+		}
+		idx = _advanceIovecs(buffers, idx, skip, written);
+	}
+	return *this;
+}
+
+
+FileMapped& FileMapped::operator=(FileMapped&& other) noexcept
+{
+	close();
+	std::swap(_file, other._file);
+	std::swap(_pMem, other._pMem);
+	std::swap(_sz, other._sz);
+	std::swap(_access, other._access);
+	std::swap(_hint, other._hint);
+	return *this;
+}
+
+void FileMapped::close() noexcept
+{
+	if (_pMem) {
+		munmap(_pMem, _sz);
+		_pMem = nullptr;
+	}
+	_sz = 0;
+	_file.close();
+}
+
+FileMapped& FileMapped::open(std::wstring_view path, Access access, bool mapWhole, File::AccessHint hint)
+{
+	close();
+	_access = access;
+	_hint = hint;
+	File::Access facc = (access == Access::ExistingReadOnly) ? File::Access::ExistingReadOnly : File::Access::ExistingRW;
+
+	_file.open(path, facc, hint);
+	_sz = _file.size();
+
+	if (mapWhole && _sz) // mmap() can't map an empty file
+		_pMem = _mapRange(0, _sz);
+	return *this;
+}
+
+size_t FileMapped::_Granularity()
+{
+	static auto granularity = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return granularity;
+}
+
+LPVOID FileMapped::_mapRange(size_t alignedOffset, size_t length) const
+{
+	int prot = PROT_READ | (_access == Access::ExistingRW ? PROT_WRITE : 0);
+	LPVOID p = mmap(nullptr, length, prot, MAP_SHARED, _file.fd(), static_cast<off_t>(alignedOffset));
+	if (p == MAP_FAILED) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "mmap failed");
+	}
+
+	if (_hint == File::AccessHint::Sequential || _hint == File::AccessHint::Random) // just a hint, failure is harmless
+		madvise(p, length, _hint == File::AccessHint::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+	return p;
+}
+
+void FileMapped::_Prefetch(LPVOID p, size_t length) noexcept
+{
+	if (!length) return;
+	size_t misalign = reinterpret_cast<uintptr_t>(p) % _Granularity(); // madvise() needs a page-aligned address
+	madvise(reinterpret_cast<BYTE*>(p) - misalign, length + misalign, MADV_WILLNEED); // just a hint, failure is harmless
+}
+
+void FileMapped::View::close() noexcept
+{
+	if (_pBase) {
+		munmap(_pBase, _baseSz);
+		_pBase = nullptr;
+	}
+	_baseSz = _offset = _sz = 0;
+	_pData = nullptr;
+}
+
+
+void FileMappedWriter::_map()
+{
+	LPVOID p = mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _file.fd(), 0);
+	if (p == MAP_FAILED) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "mmap failed");
+	}
+	_pMem = reinterpret_cast<BYTE*>(p);
+}
+
+void FileMappedWriter::_unmap() noexcept
+{
+	if (_pMem) {
+		munmap(_pMem, _capacity);
+		_pMem = nullptr;
+	}
+}
+#endif
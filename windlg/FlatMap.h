@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace lib {
+
+namespace _privflat {
+	// Branchless lower_bound: the loop compiles to conditional moves, so the
+	// number of iterations depends only on the size, never on the data.
+	template<typename It, typename Q, typename Proj, typename Cmp>
+	[[nodiscard]] It lowerBound(It first, size_t len, const Q& key, Proj proj, const Cmp& cmp) {
+		if (!len) return first;
+		while (len > 1) {
+			size_t half = len / 2;
+			first = cmp(proj(first[half - 1]), key) ? first + half : first;
+			len -= half;
+		}
+		return first + (cmp(proj(*first), key) ? 1 : 0);
+	}
+
+	// Sorts the entries by key and removes the duplicates, keeping the first occurrence.
+	template<typename T, typename Proj, typename Cmp>
+	void sortDedupe(std::vector<T>& v, Proj proj, const Cmp& cmp) {
+		std::stable_sort(v.begin(), v.end(), [&](const T& a, const T& b) -> bool {
+			return cmp(proj(a), proj(b));
+		});
+		v.erase(std::unique(v.begin(), v.end(), [&](const T& a, const T& b) -> bool {
+			return !cmp(proj(a), proj(b)) && !cmp(proj(b), proj(a));
+		}), v.end());
+	}
+}
+
+// Associative container with the keys sorted in a contiguous vector.
+// The default comparator is transparent, so a FlatMap<std::wstring, V> can be
+// searched with a std::wstring_view without creating a temporary string.
+template<typename K, typename V, typename Cmp = std::less<>>
+class FlatMap final {
+public:
+	using value_type = std::pair<K, V>;
+	using iterator = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	constexpr FlatMap() = default;
+	FlatMap(const FlatMap&) = default;
+	FlatMap(FlatMap&&) = default;
+	FlatMap& operator=(const FlatMap&) = default;
+	FlatMap& operator=(FlatMap&&) = default;
+
+	// Sorts and dedupes the entries at once; for repeated keys, the first one is kept.
+	explicit FlatMap(std::vector<value_type> entries, Cmp cmp = {})
+		: _entries{std::move(entries)}, _cmp{std::move(cmp)}
+	{
+		_privflat::sortDedupe(_entries, _key, _cmp);
+	}
+	FlatMap(std::initializer_list<value_type> entries, Cmp cmp = {})
+		: FlatMap{std::vector<value_type>{entries}, std::move(cmp)} { }
+
+	[[nodiscard]] iterator begin() { return _entries.begin(); }
+	[[nodiscard]] iterator end() { return _entries.end(); }
+	[[nodiscard]] const_iterator begin() const { return _entries.begin(); }
+	[[nodiscard]] const_iterator end() const { return _entries.end(); }
+	[[nodiscard]] size_t size() const { return _entries.size(); }
+	[[nodiscard]] bool empty() const { return _entries.empty(); }
+	void clear() { _entries.clear(); }
+	void reserve(size_t numReserve) { _entries.reserve(numReserve); }
+
+	// Returns true if the key exists.
+	template<typename Q>
+	[[nodiscard]] bool contains(const Q& key) const { return find(key) != nullptr; }
+
+	// Removes the entry with the given key; returns false if it doesn't exist.
+	template<typename Q>
+	bool erase(const Q& key) {
+		iterator it = lowerBound(key);
+		if (it == end() || _cmp(key, it->first)) return false;
+		_entries.erase(it);
+		return true;
+	}
+
+	// Returns a pointer to the value of the given key, or nullptr.
+	template<typename Q>
+	[[nodiscard]] V* find(const Q& key) {
+		iterator it = lowerBound(key);
+		return (it == end() || _cmp(key, it->first)) ? nullptr : &it->second;
+	}
+	// Returns a pointer to the value of the given key, or nullptr.
+	template<typename Q>
+	[[nodiscard]] const V* find(const Q& key) const {
+		const_iterator it = lowerBound(key);
+		return (it == end() || _cmp(key, it->first)) ? nullptr : &it->second;
+	}
+
+	// Inserts the entry if the key doesn't exist yet; returns false otherwise.
+	bool insert(K key, V val) {
+		iterator it = lowerBound(key);
+		if (it != end() && !_cmp(key, it->first)) return false;
+		_entries.emplace(it, std::move(key), std::move(val));
+		return true;
+	}
+
+	// Inserts the entry, or replaces the value if the key already exists.
+	// Returns a reference to the stored value.
+	V& set(K key, V val) {
+		iterator it = lowerBound(key);
+		if (it != end() && !_cmp(key, it->first)) {
+			it->second = std::move(val);
+			return it->second;
+		}
+		return _entries.emplace(it, std::move(key), std::move(val))->second;
+	}
+
+	// Returns an iterator to the first entry whose key is not less than the given one.
+	template<typename Q>
+	[[nodiscard]] iterator lowerBound(const Q& key) {
+		return _privflat::lowerBound(_entries.begin(), _entries.size(), key, _key, _cmp);
+	}
+	// Returns an iterator to the first entry whose key is not less than the given one.
+	template<typename Q>
+	[[nodiscard]] const_iterator lowerBound(const Q& key) const {
+		return _privflat::lowerBound(_entries.begin(), _entries.size(), key, _key, _cmp);
+	}
+
+private:
+	static constexpr auto _key = [](const value_type& entry) -> const K& { return entry.first; };
+
+	std::vector<value_type> _entries;
+	[[no_unique_address]] Cmp _cmp;
+};
+
+
+// Set container with the keys sorted in a contiguous vector.
+// The default comparator is transparent, so a FlatSet<std::wstring> can be
+// searched with a std::wstring_view without creating a temporary string.
+template<typename K, typename Cmp = std::less<>>
+class FlatSet final {
+public:
+	using value_type = K;
+	using const_iterator = typename std::vector<K>::const_iterator;
+
+	constexpr FlatSet() = default;
+	FlatSet(const FlatSet&) = default;
+	FlatSet(FlatSet&&) = default;
+	FlatSet& operator=(const FlatSet&) = default;
+	FlatSet& operator=(FlatSet&&) = default;
+
+	// Sorts and dedupes the keys at once.
+	explicit FlatSet(std::vector<K> keys, Cmp cmp = {})
+		: _keys{std::move(keys)}, _cmp{std::move(cmp)}
+	{
+		_privflat::sortDedupe(_keys, _self, _cmp);
+	}
+	FlatSet(std::initializer_list<K> keys, Cmp cmp = {})
+		: FlatSet{std::vector<K>{keys}, std::move(cmp)} { }
+
+	[[nodiscard]] const_iterator begin() const { return _keys.begin(); }
+	[[nodiscard]] const_iterator end() const { return _keys.end(); }
+	[[nodiscard]] size_t size() const { return _keys.size(); }
+	[[nodiscard]] bool empty() const { return _keys.empty(); }
+	void clear() { _keys.clear(); }
+	void reserve(size_t numReserve) { _keys.reserve(numReserve); }
+
+	// Returns true if the key exists.
+	template<typename Q>
+	[[nodiscard]] bool contains(const Q& key) const {
+		const_iterator it = lowerBound(key);
+		return it != end() && !_cmp(key, *it);
+	}
+
+	// Removes the key; returns false if it doesn't exist.
+	template<typename Q>
+	bool erase(const Q& key) {
+		const_iterator it = lowerBound(key);
+		if (it == end() || _cmp(key, *it)) return false;
+		_keys.erase(it);
+		return true;
+	}
+
+	// Inserts the key if it doesn't exist yet; returns false otherwise.
+	bool insert(K key) {
+		const_iterator it = lowerBound(key);
+		if (it != end() && !_cmp(key, *it)) return false;
+		_keys.emplace(it, std::move(key));
+		return true;
+	}
+
+	// Returns an iterator to the first key which is not less than the given one.
+	template<typename Q>
+	[[nodiscard]] const_iterator lowerBound(const Q& key) const {
+		return _privflat::lowerBound(_keys.begin(), _keys.size(), key, _self, _cmp);
+	}
+
+private:
+	static constexpr auto _self = [](const K& key) -> const K& { return key; };
+
+	std::vector<K> _keys;
+	[[no_unique_address]] Cmp _cmp;
+};
+
+}
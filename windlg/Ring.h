@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace lib {
+
+namespace _privring {
+	constexpr size_t CACHE_LINE = 64; // indices written by different threads never share a line
+
+	[[nodiscard]] constexpr size_t capacityPow2(size_t capacity) {
+		return std::bit_ceil(std::max<size_t>(capacity, 2));
+	}
+}
+
+// Bounded lock-free queue with a single producer and a single consumer thread.
+// Capacity is rounded up to a power of two; T must be default-constructible.
+// Example:
+// SpscRing<Entry> ring{4096}; // shared by the worker and the UI thread
+// ring.push(entry); // worker thread
+// ring.drain([&](Entry& e) { list.items.add(e.name); }); // UI thread
+template<typename T>
+class SpscRing final {
+public:
+	SpscRing(const SpscRing&) = delete;
+	SpscRing(SpscRing&&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+	SpscRing& operator=(SpscRing&&) = delete;
+
+	explicit SpscRing(size_t capacity)
+		: _mask{_privring::capacityPow2(capacity) - 1}, _slots(_mask + 1) { }
+
+	[[nodiscard]] size_t capacity() const { return _mask + 1; }
+
+	// Consumer thread: calls the callback on each available element, up to maxCount.
+	// Returns the number of consumed elements.
+	template<typename F>
+	size_t drain(F&& callback, size_t maxCount = SIZE_MAX) {
+		size_t head = _head.load(std::memory_order_relaxed);
+		size_t count = std::min(_available(head, maxCount), maxCount);
+		for (size_t i = 0; i < count; ++i)
+			callback(_slots[(head + i) & _mask]);
+		_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	// Consumer thread: returns the next element, if any.
+	[[nodiscard]] std::optional<T> pop() {
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (!_available(head, 1)) return std::nullopt;
+		std::optional<T> val{std::move(_slots[head & _mask])};
+		_head.store(head + 1, std::memory_order_release);
+		return val;
+	}
+
+	// Consumer thread: moves up to dest.size() elements into dest.
+	// Returns the number of moved elements.
+	size_t popBatch(std::span<T> dest) {
+		return drain([&, i = size_t{0}](T& val) mutable { dest[i++] = std::move(val); }, dest.size());
+	}
+
+	// Producer thread: moves the element into the ring; returns false if full.
+	bool push(T val) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (!_free(tail, 1)) return false;
+		_slots[tail & _mask] = std::move(val);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer thread: moves as many elements as there's room for, publishing them at once.
+	// Returns the number of moved elements.
+	size_t pushBatch(std::span<T> vals) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		size_t count = std::min(_free(tail, vals.size()), vals.size());
+		for (size_t i = 0; i < count; ++i)
+			_slots[(tail + i) & _mask] = std::move(vals[i]);
+		_tail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	// Number of elements ready to be consumed; reloads the producer index only if needed.
+	[[nodiscard]] size_t _available(size_t head, size_t wanted) {
+		if (_tailCached - head < wanted)
+			_tailCached = _tail.load(std::memory_order_acquire);
+		return _tailCached - head;
+	}
+
+	// Number of free slots; reloads the consumer index only if needed.
+	[[nodiscard]] size_t _free(size_t tail, size_t wanted) {
+		if (capacity() - (tail - _headCached) < wanted)
+			_headCached = _head.load(std::memory_order_acquire);
+		return capacity() - (tail - _headCached);
+	}
+
+	const size_t _mask;
+	std::vector<T> _slots;
+	alignas(_privring::CACHE_LINE) std::atomic<size_t> _tail{0}; // written by producer
+	size_t _headCached = 0; // producer's copy of _head
+	alignas(_privring::CACHE_LINE) std::atomic<size_t> _head{0}; // written by consumer
+	size_t _tailCached = 0; // consumer's copy of _tail
+};
+
+
+// Bounded lock-free queue with many producer threads and a single consumer thread.
+// Capacity is rounded up to a power of two; T must be default-constructible.
+// Example:
+// MpscQueue<Entry> queue{4096}; // shared by the workers and the UI thread
+// queue.push(entry); // any worker thread
+// queue.drain([&](Entry& e) { list.items.add(e.name); }); // UI thread
+template<typename T>
+class MpscQueue final {
+public:
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue(MpscQueue&&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+	MpscQueue& operator=(MpscQueue&&) = delete;
+
+	explicit MpscQueue(size_t capacity)
+		: _mask{_privring::capacityPow2(capacity) - 1},
+			_cells{std::make_unique<Cell[]>(_mask + 1)}
+	{
+		for (size_t i = 0; i <= _mask; ++i)
+			_cells[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] size_t capacity() const { return _mask + 1; }
+
+	// Consumer thread: calls the callback on each available element, up to maxCount.
+	// Returns the number of consumed elements.
+	template<typename F>
+	size_t drain(F&& callback, size_t maxCount = SIZE_MAX) {
+		size_t count = 0;
+		for (; count < maxCount; ++count) {
+			Cell& cell = _cells[_head & _mask];
+			if (cell.seq.load(std::memory_order_acquire) != _head + 1) break; // not published yet
+			callback(cell.val);
+			cell.seq.store(_head + _mask + 1, std::memory_order_release); // free for the next lap
+			++_head;
+		}
+		return count;
+	}
+
+	// Consumer thread: returns the next element, if any.
+	[[nodiscard]] std::optional<T> pop() {
+		std::optional<T> ret;
+		drain([&](T& val) { ret.emplace(std::move(val)); }, 1);
+		return ret;
+	}
+
+	// Consumer thread: moves up to dest.size() elements into dest.
+	// Returns the number of moved elements.
+	size_t popBatch(std::span<T> dest) {
+		return drain([&, i = size_t{0}](T& val) mutable { dest[i++] = std::move(val); }, dest.size());
+	}
+
+	// Any producer thread: moves the element into the queue; returns false if full.
+	bool push(T val) {
+		return pushBatch(std::span{&val, 1}) == 1;
+	}
+
+	// Any producer thread: claims a contiguous block of slots with a single atomic
+	// operation, and moves the elements into it. If the queue doesn't have room for
+	// all of them, the block is halved until it fits.
+	// Returns the number of moved elements.
+	size_t pushBatch(std::span<T> vals) {
+		size_t count = std::min(vals.size(), capacity());
+		size_t pos = _tail.load(std::memory_order_relaxed);
+		while (count) {
+			// Slots are freed in order, so if the last one of the block is free, all of them are.
+			size_t lastPos = pos + count - 1;
+			auto dif = static_cast<ptrdiff_t>(_cells[lastPos & _mask].seq.load(std::memory_order_acquire) - lastPos);
+			if (dif == 0) {
+				if (_tail.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+					break; // block claimed
+			} else if (dif < 0) {
+				count /= 2; // not enough room
+			} else {
+				pos = _tail.load(std::memory_order_relaxed); // another producer claimed it
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			Cell& cell = _cells[(pos + i) & _mask];
+			cell.val = std::move(vals[i]);
+			cell.seq.store(pos + i + 1, std::memory_order_release); // publish to consumer
+		}
+		return count;
+	}
+
+private:
+	struct Cell final {
+		std::atomic<size_t> seq{0};
+		T val{};
+	};
+
+	const size_t _mask;
+	std::unique_ptr<Cell[]> _cells;
+	alignas(_privring::CACHE_LINE) std::atomic<size_t> _tail{0}; // shared by producers
+	alignas(_privring::CACHE_LINE) size_t _head = 0; // owned by consumer
+};
+
+}
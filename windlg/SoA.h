@@ -0,0 +1,111 @@
+#pragma once
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lib {
+
+// Structure-of-arrays container: each field is stored in its own contiguous
+// vector, so scanning, sorting or filtering by one column doesn't drag the
+// other fields through the cache. Rows are accessed as tuples of references.
+// Example:
+// SoA<std::wstring, size_t, DWORD> files;
+// files.pushBack(L"a.txt", 1024, FILE_ATTRIBUTE_NORMAL);
+// auto [name, size, attrs] = files[0];
+// std::span<size_t> sizes = files.column<1>();
+template<typename... Ts>
+class SoA final {
+	static_assert(sizeof...(Ts) > 0, "SoA must have at least one column.");
+	static_assert((!std::is_same_v<Ts, bool> && ...), "SoA bool column can't be a span, use BYTE instead.");
+
+public:
+	// Type of the column I.
+	template<size_t I>
+	using Col = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	// Mutable row proxy, returned by operator[].
+	using Row = std::tuple<Ts&...>;
+	// Immutable row proxy, returned by operator[].
+	using ConstRow = std::tuple<const Ts&...>;
+
+	static constexpr size_t NUM_COLUMNS = sizeof...(Ts);
+
+	constexpr SoA() = default;
+	SoA(const SoA&) = default;
+	SoA(SoA&&) = default;
+	SoA& operator=(const SoA&) = default;
+	SoA& operator=(SoA&&) = default;
+
+	[[nodiscard]] Row operator[](size_t index) { return _row(index, _IDXS); }
+	[[nodiscard]] ConstRow operator[](size_t index) const { return _row(index, _IDXS); }
+
+	void clear() { _forEachCol([](auto& col) { col.clear(); }); }
+
+	// Returns a span over the contiguous values of the column I.
+	template<size_t I>
+	[[nodiscard]] std::span<Col<I>> column() { return std::get<I>(_cols); }
+	// Returns a span over the contiguous values of the column I.
+	template<size_t I>
+	[[nodiscard]] std::span<const Col<I>> column() const { return std::get<I>(_cols); }
+
+	[[nodiscard]] bool empty() const { return std::get<0>(_cols).empty(); }
+
+	// Rearranges all columns at once; the new row i will be the old row order[i].
+	// The order must be a permutation of [0, size()).
+	void permute(std::span<const size_t> order) {
+		_forEachCol([&](auto& col) {
+			std::remove_reference_t<decltype(col)> newCol;
+			newCol.reserve(col.size());
+			for (size_t oldIdx : order)
+				newCol.emplace_back(std::move(col[oldIdx]));
+			col.swap(newCol);
+		});
+	}
+
+	// Appends a new row, one value for each column.
+	void pushBack(Ts... vals) { _pushBack(std::forward_as_tuple(std::move(vals)...), _IDXS); }
+	// Appends a new row from a tuple.
+	void pushBack(std::tuple<Ts...> row) { _pushBack(std::move(row), _IDXS); }
+
+	// Removes the row at the given index.
+	void remove(size_t index) { _forEachCol([=](auto& col) { col.erase(col.begin() + index); }); }
+
+	void reserve(size_t numReserve) { _forEachCol([=](auto& col) { col.reserve(numReserve); }); }
+	void resize(size_t numRows) { _forEachCol([=](auto& col) { col.resize(numRows); }); }
+	[[nodiscard]] size_t size() const { return std::get<0>(_cols).size(); }
+
+	void swapRows(size_t a, size_t b) {
+		_forEachCol([=](auto& col) {
+			using std::swap;
+			swap(col[a], col[b]);
+		});
+	}
+
+private:
+	static constexpr auto _IDXS = std::index_sequence_for<Ts...>{};
+
+	template<size_t... Is>
+	[[nodiscard]] Row _row(size_t index, std::index_sequence<Is...>) {
+		return Row{std::get<Is>(_cols)[index]...};
+	}
+	template<size_t... Is>
+	[[nodiscard]] ConstRow _row(size_t index, std::index_sequence<Is...>) const {
+		return ConstRow{std::get<Is>(_cols)[index]...};
+	}
+
+	template<typename Tup, size_t... Is>
+	void _pushBack(Tup&& row, std::index_sequence<Is...>) {
+		(std::get<Is>(_cols).emplace_back(std::get<Is>(std::forward<Tup>(row))), ...);
+	}
+
+	template<typename F>
+	void _forEachCol(F&& func) {
+		std::apply([&](auto&... cols) { (func(cols), ...); }, _cols);
+	}
+
+	std::tuple<std::vector<Ts>...> _cols;
+};
+
+}
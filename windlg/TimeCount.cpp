@@ -1,18 +1,14 @@
 #include <cmath>
 #include <system_error>
+#include <time.h>
 #include "TimeCount.h"
 using namespace lib;
 
+#ifdef _WIN32
 static LONGLONG _freq = 0;
 
-TimeCount TimeCount::Immediately()
-{
-	TimeCount t;
-	t.restart();
-	return t;
-}
-
-void TimeCount::restart()
+// Returns the counter frequency, in ticks per second.
+static LONGLONG _frequency()
 {
 	if (!_freq) { // frequency not cached yet?
 		LARGE_INTEGER theFreq{};
@@ -21,17 +17,46 @@ void TimeCount::restart()
 		}
 		_freq = theFreq.QuadPart; // cache frequency
 	}
+	return _freq;
+}
+
+static LONGLONG _counter()
+{
+	LARGE_INTEGER t{};
+	QueryPerformanceCounter(&t);
+	return t.QuadPart;
+}
+#else
+// Returns the counter frequency, in ticks per second.
+static LONGLONG _frequency()
+{
+	return 1'000'000'000; // clock_gettime() has nanosecond resolution
+}
+
+static LONGLONG _counter()
+{
+	timespec t{};
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * _frequency() + t.tv_nsec;
+}
+#endif
 
-	LARGE_INTEGER t0;
-	QueryPerformanceCounter(&t0);
-	_t0 = t0.QuadPart;
+TimeCount TimeCount::Immediately()
+{
+	TimeCount t;
+	t.restart();
+	return t;
+}
+
+void TimeCount::restart()
+{
+	_frequency(); // cache frequency before counting
+	_t0 = _counter();
 }
 
 TimeCount::Duration TimeCount::now() const
 {
-	LARGE_INTEGER t1{};
-	QueryPerformanceCounter(&t1);
-	auto ms = static_cast<LONGLONG>(std::round( (t1.QuadPart - _t0) / (_freq / 1000.) ));
+	auto ms = static_cast<LONGLONG>(std::round( (_counter() - _t0) / (_frequency() / 1000.) ));
 
 	Duration dur{};
 	dur.ms = ms % 1000;
@@ -0,0 +1,609 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <execution>
+#include <mutex>
+#include <system_error>
+#include "File.h"
+#include "hash.h"
+using namespace lib;
+
+#ifdef _MSC_VER
+#include <intrin.h> // __cpuid(), __umulh()
+#endif
+#if defined(_M_X64) || defined(__x86_64__)
+#define HASH_X64
+#include <immintrin.h>
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC and Clang only emit instructions beyond the baseline in functions marked
+// with them; MSVC emits any intrinsic anywhere.
+#if defined(HASH_X64) && !defined(_MSC_VER)
+#define HASH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define HASH_TARGET(isa)
+#endif
+
+// All loads are little-endian, like every platform Windows runs on.
+static uint32_t _read32(const BYTE* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static uint64_t _read64(const BYTE* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+// Compilers turn these into a single bswap instruction.
+static uint32_t _byteSwap32(uint32_t v)
+{
+	return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff'0000) | (v << 24);
+}
+
+static uint64_t _byteSwap64(uint64_t v)
+{
+	return (uint64_t{_byteSwap32(static_cast<uint32_t>(v))} << 32) | _byteSwap32(static_cast<uint32_t>(v >> 32));
+}
+
+#ifdef HASH_X64
+struct CpuFeatures final {
+	bool sse42 = false;
+	bool sha = false; // SHA extensions, along with the SSSE3 and SSE4.1 they need
+};
+
+static const CpuFeatures& _cpu()
+{
+	static const CpuFeatures feats = []() {
+		unsigned int r1[4]{}, r7[4]{};
+#ifdef _MSC_VER
+		__cpuid(reinterpret_cast<int*>(r1), 1);
+		__cpuidex(reinterpret_cast<int*>(r7), 7, 0);
+#else
+		__get_cpuid_count(1, 0, &r1[0], &r1[1], &r1[2], &r1[3]);
+		__get_cpuid_count(7, 0, &r7[0], &r7[1], &r7[2], &r7[3]);
+#endif
+		CpuFeatures f;
+		f.sse42 = r1[2] & (1 << 20);
+		f.sha = (r7[1] & (1 << 29)) && (r1[2] & (1 << 19)) && (r1[2] & (1 << 9));
+		return f;
+	}();
+	return feats;
+}
+#endif
+
+
+std::wstring hash::Digest::hex() const
+{
+	constexpr WCHAR digits[] = L"0123456789abcdef";
+	std::wstring ret(len * 2, L'\0');
+	for (size_t i = 0; i < len; ++i) {
+		ret[i * 2] = digits[bytes[i] >> 4];
+		ret[i * 2 + 1] = digits[bytes[i] & 0xf];
+	}
+	return ret;
+}
+
+
+// Slicing-by-8 tables of the reflected Castagnoli polynomial.
+static constexpr auto _crcTable = []() {
+	std::array<std::array<uint32_t, 256>, 8> t{};
+	for (uint32_t i = 0; i < 256; ++i) {
+		uint32_t c = i;
+		for (int k = 0; k < 8; ++k)
+			c = (c >> 1) ^ (0x82f6'3b78 & (0 - (c & 1)));
+		t[0][i] = c;
+	}
+	for (uint32_t i = 0; i < 256; ++i) {
+		for (size_t s = 1; s < 8; ++s)
+			t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+	}
+	return t;
+}();
+
+static uint32_t _crc32cTable(uint32_t crc, const BYTE* p, size_t len)
+{
+	const auto& t = _crcTable;
+	for (; len >= 8; p += 8, len -= 8) {
+		uint64_t v = _read64(p) ^ crc;
+		crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff]
+			^ t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+	}
+	for (; len; ++p, --len)
+		crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+	return crc;
+}
+
+#ifdef HASH_X64
+HASH_TARGET("sse4.2") static uint32_t _crc32cSse42(uint32_t crc, const BYTE* p, size_t len)
+{
+	uint64_t crc64 = crc;
+	for (; len >= 8; p += 8, len -= 8)
+		crc64 = _mm_crc32_u64(crc64, _read64(p));
+	crc = static_cast<uint32_t>(crc64);
+	for (; len; ++p, --len)
+		crc = _mm_crc32_u8(crc, *p);
+	return crc;
+}
+#endif
+
+hash::Crc32c& hash::Crc32c::update(std::span<const BYTE> data)
+{
+#ifdef HASH_X64
+	if (_cpu().sse42) {
+		_crc = _crc32cSse42(_crc, data.data(), data.size());
+		return *this;
+	}
+#endif
+	_crc = _crc32cTable(_crc, data.data(), data.size());
+	return *this;
+}
+
+
+// XXH3 constants and default secret, from the xxHash specification.
+constexpr uint32_t XXH_PRIME32_1 = 0x9e37'79b1, XXH_PRIME32_2 = 0x85eb'ca77, XXH_PRIME32_3 = 0xc2b2'ae3d;
+constexpr uint64_t XXH_PRIME64_1 = 0x9e37'79b1'85eb'ca87, XXH_PRIME64_2 = 0xc2b2'ae3d'27d4'eb4f,
+	XXH_PRIME64_3 = 0x1656'67b1'9e37'79f9, XXH_PRIME64_4 = 0x85eb'ca77'c2b2'ae63, XXH_PRIME64_5 = 0x27d4'eb2f'1656'67c5;
+constexpr uint64_t XXH_PRIME_MX1 = 0x1656'6791'9e37'79f9, XXH_PRIME_MX2 = 0x9fb2'1c65'1e98'df25;
+constexpr size_t XXH_STRIPE_LEN = 64;
+constexpr size_t XXH_SECRET_SZ = 192;
+constexpr size_t XXH_STRIPES_PER_BLOCK = (XXH_SECRET_SZ - XXH_STRIPE_LEN) / 8;
+constexpr size_t XXH_MIDSIZE_MAX = 240; // longer inputs use the stripe loop
+
+alignas(16) constexpr BYTE _xxhSecret[XXH_SECRET_SZ] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Multiplies into 128 bits, then XORs the high and low halves.
+static uint64_t _mulFold64(uint64_t a, uint64_t b)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	return (a * b) ^ __umulh(a, b);
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 prod = static_cast<unsigned __int128>(a) * b;
+	return static_cast<uint64_t>(prod) ^ static_cast<uint64_t>(prod >> 64);
+#else // 32-bit targets, from four 32x32 partial products
+	uint64_t aLo = a & 0xffff'ffff, aHi = a >> 32;
+	uint64_t bLo = b & 0xffff'ffff, bHi = b >> 32;
+	uint64_t loLo = aLo * bLo, hiLo = aHi * bLo, loHi = aLo * bHi, hiHi = aHi * bHi;
+	uint64_t cross = (loLo >> 32) + (hiLo & 0xffff'ffff) + loHi; // can't overflow
+	uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
+	uint64_t lo = (cross << 32) | (loLo & 0xffff'ffff);
+	return lo ^ hi;
+#endif
+}
+
+static uint64_t _xxh64Avalanche(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	return h ^ (h >> 32);
+}
+
+static uint64_t _xxh3Avalanche(uint64_t h)
+{
+	h ^= h >> 37;
+	h *= XXH_PRIME_MX1;
+	return h ^ (h >> 32);
+}
+
+static uint64_t _xxhMix16(const BYTE* p, const BYTE* secret)
+{
+	return _mulFold64(_read64(p) ^ _read64(secret), _read64(p + 8) ^ _read64(secret + 8));
+}
+
+// One-shot hash of inputs up to XXH_MIDSIZE_MAX bytes, which don't touch the accumulators.
+static uint64_t _xxh3Short(const BYTE* p, size_t len)
+{
+	const BYTE* s = _xxhSecret;
+	if (len == 0) {
+		return _xxh64Avalanche(_read64(s + 56) ^ _read64(s + 64));
+	} else if (len <= 3) {
+		uint32_t combined = (uint32_t{p[0]} << 16) | (uint32_t{p[len >> 1]} << 24)
+			| uint32_t{p[len - 1]} | (static_cast<uint32_t>(len) << 8);
+		return _xxh64Avalanche(combined ^ static_cast<uint64_t>(_read32(s) ^ _read32(s + 4)));
+	} else if (len <= 8) {
+		uint64_t input = _read32(p + len - 4) + (uint64_t{_read32(p)} << 32);
+		uint64_t h = input ^ (_read64(s + 8) ^ _read64(s + 16));
+		h ^= std::rotl(h, 49) ^ std::rotl(h, 24);
+		h *= XXH_PRIME_MX2;
+		h ^= (h >> 35) + len;
+		h *= XXH_PRIME_MX2;
+		return h ^ (h >> 28);
+	} else if (len <= 16) {
+		uint64_t lo = _read64(p) ^ (_read64(s + 24) ^ _read64(s + 32));
+		uint64_t hi = _read64(p + len - 8) ^ (_read64(s + 40) ^ _read64(s + 48));
+		return _xxh3Avalanche(len + _byteSwap64(lo) + hi + _mulFold64(lo, hi));
+	} else if (len <= 128) {
+		uint64_t acc = len * XXH_PRIME64_1;
+		for (size_t i = 0; i < (len - 1) / 32 + 1; ++i) { // pairs from both ends, inwards
+			acc += _xxhMix16(p + 16 * i, s + 32 * i);
+			acc += _xxhMix16(p + len - 16 * (i + 1), s + 32 * i + 16);
+		}
+		return _xxh3Avalanche(acc);
+	} else {
+		uint64_t acc = len * XXH_PRIME64_1;
+		for (size_t i = 0; i < 8; ++i)
+			acc += _xxhMix16(p + 16 * i, s + 16 * i);
+		acc = _xxh3Avalanche(acc);
+		for (size_t i = 8; i < len / 16; ++i)
+			acc += _xxhMix16(p + 16 * i, s + 16 * (i - 8) + 3);
+		acc += _xxhMix16(p + len - 16, s + 136 - 17);
+		return _xxh3Avalanche(acc);
+	}
+}
+
+static void _xxhAccumulate512(uint64_t* acc, const BYTE* p, const BYTE* secret)
+{
+#ifdef HASH_X64 // SSE2 is always present on x64
+	auto* acc128 = reinterpret_cast<__m128i*>(acc);
+	for (size_t i = 0; i < 4; ++i) {
+		__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i);
+		__m128i key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+		__m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+		__m128i sum = _mm_add_epi64(_mm_load_si128(acc128 + i), _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+		_mm_store_si128(acc128 + i, _mm_add_epi64(product, sum));
+	}
+#else
+	for (size_t i = 0; i < 8; ++i) {
+		uint64_t data = _read64(p + 8 * i);
+		uint64_t key = data ^ _read64(secret + 8 * i);
+		acc[i ^ 1] += data;
+		acc[i] += (key & 0xffff'ffff) * (key >> 32);
+	}
+#endif
+}
+
+static void _xxhScramble(uint64_t* acc, const BYTE* secret)
+{
+#ifdef HASH_X64
+	auto* acc128 = reinterpret_cast<__m128i*>(acc);
+	const __m128i prime = _mm_set1_epi32(static_cast<int>(XXH_PRIME32_1));
+	for (size_t i = 0; i < 4; ++i) {
+		__m128i a = _mm_load_si128(acc128 + i);
+		a = _mm_xor_si128(_mm_xor_si128(a, _mm_srli_epi64(a, 47)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+		__m128i prodLo = _mm_mul_epu32(a, prime);
+		__m128i prodHi = _mm_mul_epu32(_mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+		_mm_store_si128(acc128 + i, _mm_add_epi64(prodLo, _mm_slli_epi64(prodHi, 32)));
+	}
+#else
+	for (size_t i = 0; i < 8; ++i) {
+		uint64_t a = acc[i];
+		a ^= a >> 47;
+		a ^= _read64(secret + 8 * i);
+		acc[i] = a * XXH_PRIME32_1;
+	}
+#endif
+}
+
+// Consumes numStripes stripes, scrambling the accumulators at the end of each block.
+static void _xxhConsumeStripes(uint64_t* acc, size_t& stripesInBlock, const BYTE* p, size_t numStripes)
+{
+	for (size_t i = 0; i < numStripes; ++i) {
+		_xxhAccumulate512(acc, p + i * XXH_STRIPE_LEN, _xxhSecret + stripesInBlock * 8);
+		if (++stripesInBlock == XXH_STRIPES_PER_BLOCK) {
+			_xxhScramble(acc, _xxhSecret + XXH_SECRET_SZ - XXH_STRIPE_LEN);
+			stripesInBlock = 0;
+		}
+	}
+}
+
+uint64_t hash::Xxh3::digest() const
+{
+	if (_totalLen <= XXH_MIDSIZE_MAX)
+		return _xxh3Short(_buf.data(), _bufLen); // whole input is still in the buffer
+
+	alignas(16) std::array<uint64_t, 8> acc = _acc; // digest() doesn't change the state
+	size_t stripesInBlock = _numStripes;
+	BYTE lastStripe[XXH_STRIPE_LEN];
+	if (_bufLen >= XXH_STRIPE_LEN) {
+		_xxhConsumeStripes(acc.data(), stripesInBlock, _buf.data(), (_bufLen - 1) / XXH_STRIPE_LEN);
+		memcpy(lastStripe, _buf.data() + _bufLen - XXH_STRIPE_LEN, XXH_STRIPE_LEN);
+	} else { // last stripe starts in the previous bytes, kept at the end of the buffer
+		size_t prevLen = XXH_STRIPE_LEN - _bufLen;
+		memcpy(lastStripe, _buf.data() + _BUF_SZ - prevLen, prevLen);
+		memcpy(lastStripe + prevLen, _buf.data(), _bufLen);
+	}
+	_xxhAccumulate512(acc.data(), lastStripe, _xxhSecret + XXH_SECRET_SZ - XXH_STRIPE_LEN - 7);
+
+	uint64_t ret = _totalLen * XXH_PRIME64_1;
+	for (size_t i = 0; i < 4; ++i) {
+		ret += _mulFold64(acc[2 * i] ^ _read64(_xxhSecret + 11 + 16 * i),
+			acc[2 * i + 1] ^ _read64(_xxhSecret + 11 + 16 * i + 8));
+	}
+	return _xxh3Avalanche(ret);
+}
+
+hash::Xxh3& hash::Xxh3::reset()
+{
+	_acc = {XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+		XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1};
+	_bufLen = 0;
+	_numStripes = 0;
+	_totalLen = 0;
+	return *this;
+}
+
+hash::Xxh3& hash::Xxh3::update(std::span<const BYTE> data)
+{
+	_totalLen += data.size();
+	if (_bufLen + data.size() <= _BUF_SZ) { // the buffer is never left empty, digest() needs the last bytes
+		std::copy(data.begin(), data.end(), _buf.begin() + _bufLen);
+		_bufLen += data.size();
+		return *this;
+	}
+
+	if (_bufLen) {
+		size_t fill = _BUF_SZ - _bufLen;
+		std::copy_n(data.begin(), fill, _buf.begin() + _bufLen);
+		_xxhConsumeStripes(_acc.data(), _numStripes, _buf.data(), _BUF_SZ / XXH_STRIPE_LEN);
+		data = data.subspan(fill);
+		_bufLen = 0;
+	}
+
+	if (data.size() > _BUF_SZ) {
+		size_t numStripes = (data.size() - 1) / XXH_STRIPE_LEN; // keep at least 1 byte buffered
+		_xxhConsumeStripes(_acc.data(), _numStripes, data.data(), numStripes);
+		data = data.subspan(numStripes * XXH_STRIPE_LEN);
+		std::copy_n(data.data() - XXH_STRIPE_LEN, XXH_STRIPE_LEN, _buf.end() - XXH_STRIPE_LEN); // for digest()
+	}
+
+	std::copy(data.begin(), data.end(), _buf.begin());
+	_bufLen = data.size();
+	return *this;
+}
+
+
+alignas(16) constexpr uint32_t _sha256K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void _sha256Blocks(uint32_t* state, const BYTE* p, size_t numBlocks)
+{
+	for (; numBlocks; --numBlocks, p += 64) {
+		uint32_t w[64];
+		for (size_t i = 0; i < 16; ++i)
+			w[i] = _byteSwap32(_read32(p + 4 * i));
+		for (size_t i = 16; i < 64; ++i) {
+			uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+			e = state[4], f = state[5], g = state[6], h = state[7];
+		for (size_t i = 0; i < 64; ++i) {
+			uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25))
+				+ ((e & f) ^ (~e & g)) + _sha256K[i] + w[i];
+			uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22))
+				+ ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+#ifdef HASH_X64
+// Each iteration runs 4 rounds; the state is kept as ABEF and CDGH, as required by
+// the SHA instructions.
+HASH_TARGET("sha,sse4.1,ssse3") static void _sha256BlocksShaNi(uint32_t* state, const BYTE* p, size_t numBlocks)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d'0e0f'0809'0a0b, 0x0405'0607'0001'0203);
+	__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1); // CDAB
+	__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b); // EFGH
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0); // CDGH
+
+	for (; numBlocks; --numBlocks, p += 64) {
+		__m128i abefSave = state0, cdghSave = state1;
+		__m128i msg[4];
+		for (size_t i = 0; i < 16; ++i) {
+			__m128i& m = msg[i % 4]; // words 4*i to 4*i+3 of the schedule
+			if (i < 4) {
+				m = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i), bswap);
+			} else {
+				m = _mm_add_epi32(_mm_sha256msg1_epu32(m, msg[(i - 3) % 4]),
+					_mm_alignr_epi8(msg[(i - 1) % 4], msg[(i - 2) % 4], 4));
+				m = _mm_sha256msg2_epu32(m, msg[(i - 1) % 4]);
+			}
+			__m128i wk = _mm_add_epi32(m, _mm_load_si128(reinterpret_cast<const __m128i*>(_sha256K) + i));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0e));
+		}
+		state0 = _mm_add_epi32(state0, abefSave);
+		state1 = _mm_add_epi32(state1, cdghSave);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b); // FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xb1); // DCHG
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(tmp, state1, 0xf0)); // DCBA
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(state1, tmp, 8)); // HGFE
+}
+#endif
+
+static void _sha256Process(uint32_t* state, const BYTE* p, size_t numBlocks)
+{
+#ifdef HASH_X64
+	if (_cpu().sha) {
+		_sha256BlocksShaNi(state, p, numBlocks);
+		return;
+	}
+#endif
+	_sha256Blocks(state, p, numBlocks);
+}
+
+std::array<BYTE, 32> hash::Sha256::digest() const
+{
+	std::array<uint32_t, 8> state = _state; // digest() doesn't change the state
+	BYTE tail[128]{}; // padding may spill into a second block
+	memcpy(tail, _buf.data(), _bufLen);
+	tail[_bufLen] = 0x80;
+	size_t tailLen = (_bufLen < 56) ? 64 : 128;
+	uint64_t numBits = _byteSwap64(_totalLen * 8);
+	memcpy(tail + tailLen - 8, &numBits, 8);
+	_sha256Process(state.data(), tail, tailLen / 64);
+
+	std::array<BYTE, 32> ret;
+	for (size_t i = 0; i < 8; ++i) {
+		uint32_t word = _byteSwap32(state[i]);
+		memcpy(ret.data() + 4 * i, &word, 4);
+	}
+	return ret;
+}
+
+hash::Sha256& hash::Sha256::reset()
+{
+	_state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	_bufLen = 0;
+	_totalLen = 0;
+	return *this;
+}
+
+hash::Sha256& hash::Sha256::update(std::span<const BYTE> data)
+{
+	_totalLen += data.size();
+	if (_bufLen) {
+		size_t fill = std::min(data.size(), _buf.size() - _bufLen);
+		std::copy_n(data.begin(), fill, _buf.begin() + _bufLen);
+		_bufLen += fill;
+		data = data.subspan(fill);
+		if (_bufLen < _buf.size()) return *this;
+		_sha256Process(_state.data(), _buf.data(), 1);
+		_bufLen = 0;
+	}
+
+	size_t numBlocks = data.size() / 64; // whole blocks are hashed straight from the input
+	_sha256Process(_state.data(), data.data(), numBlocks);
+	data = data.subspan(numBlocks * 64);
+
+	std::copy(data.begin(), data.end(), _buf.begin());
+	_bufLen = data.size();
+	return *this;
+}
+
+
+static hash::Digest _digestOf(uint64_t val, size_t len)
+{
+	hash::Digest ret{.len = len};
+	for (size_t i = 0; i < len; ++i) // big-endian, as usually printed
+		ret.bytes[i] = static_cast<BYTE>(val >> (8 * (len - 1 - i)));
+	return ret;
+}
+
+hash::Hasher::Hasher(Algo algo)
+{
+	switch (algo) {
+	case Algo::Crc32c:
+		_h.emplace<Crc32c>();
+		break;
+	case Algo::Xxh3:
+		_h.emplace<Xxh3>();
+		break;
+	case Algo::Sha256:
+		_h.emplace<Sha256>();
+	}
+}
+
+hash::Digest hash::Hasher::digest() const
+{
+	if (auto* crc = std::get_if<Crc32c>(&_h)) {
+		return _digestOf(crc->digest(), 4);
+	} else if (auto* xxh = std::get_if<Xxh3>(&_h)) {
+		return _digestOf(xxh->digest(), 8);
+	} else {
+		Digest ret{.len = 32};
+		ret.bytes = std::get<Sha256>(_h).digest();
+		return ret;
+	}
+}
+
+hash::Hasher& hash::Hasher::reset()
+{
+	std::visit([](auto& h) { h.reset(); }, _h);
+	return *this;
+}
+
+hash::Hasher& hash::Hasher::update(std::span<const BYTE> data)
+{
+	std::visit([&](auto& h) { h.update(data); }, _h);
+	return *this;
+}
+
+
+hash::Digest hash::hashFile(std::wstring_view path, Algo algo)
+{
+	constexpr size_t MAPPED_MIN = 1024 * 1024; // smaller files are cheaper to read at once than to map
+	constexpr size_t WINDOW_SIZE = 64 * 1024 * 1024;
+
+	Hasher h{algo};
+	{
+		File f{path, File::Access::ExistingReadOnly, File::AccessHint::Sequential};
+		if (size_t sz = f.size(); sz < MAPPED_MIN) { // also empty files, which can't be mapped
+			std::vector<BYTE> buf(sz);
+			h.update(std::span{buf.data(), f.read(buf)});
+			return h.digest();
+		}
+	}
+
+	FileMapped f{path, FileMapped::Access::ExistingReadOnly, false, File::AccessHint::Sequential};
+	f.forEachWindow(WINDOW_SIZE, 0, [&](std::span<BYTE> window, size_t) {
+		h.update(window);
+	});
+	return h.digest();
+}
+
+std::vector<std::optional<hash::Digest>> hash::hashFiles(std::span<const std::wstring> paths, Algo algo)
+{
+	std::vector<std::optional<Digest>> ret(paths.size());
+	std::mutex mtx;
+	std::exception_ptr err; // first one which isn't a file error
+
+	std::transform(std::execution::par, paths.begin(), paths.end(), ret.begin(),
+		[&](const std::wstring& path) -> std::optional<Digest> {
+			try { // exceptions can't escape a parallel algorithm, they would terminate
+				return hashFile(path, algo);
+			} catch (const std::system_error&) {
+				return std::nullopt;
+			} catch (...) {
+				std::lock_guard lock{mtx};
+				if (!err) err = std::current_exception();
+				return std::nullopt;
+			}
+		});
+
+	if (err) [[unlikely]] {
+		std::rethrow_exception(err);
+	}
+	return ret;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "sys.h"
+
+namespace lib::hash {
+
+// Hash algorithms supported by Hasher and hashFile().
+enum class Algo { Crc32c, Xxh3, Sha256 };
+
+// Result of a hash, with the bytes in the same order they're usually printed.
+struct Digest final {
+	std::array<BYTE, 32> bytes{};
+	size_t len = 0;
+
+	[[nodiscard]] bool operator==(const Digest&) const = default;
+
+	[[nodiscard]] std::span<const BYTE> asSpan() const { return std::span{bytes.data(), len}; }
+	// Returns the digest as lowercase hexadecimal digits.
+	[[nodiscard]] std::wstring hex() const;
+};
+
+// Streaming CRC-32C (Castagnoli), using the SSE4.2 instruction when available.
+class Crc32c final {
+public:
+	constexpr Crc32c() = default;
+	constexpr Crc32c(const Crc32c&) = default;
+	constexpr Crc32c(Crc32c&&) = default;
+	constexpr Crc32c& operator=(const Crc32c&) = default;
+	constexpr Crc32c& operator=(Crc32c&&) = default;
+
+	[[nodiscard]] constexpr uint32_t digest() const { return ~_crc; }
+	constexpr Crc32c& reset() { _crc = 0xffff'ffff; return *this; }
+	Crc32c& update(std::span<const BYTE> data);
+
+private:
+	uint32_t _crc = 0xffff'ffff;
+};
+
+// Streaming XXH3 64-bit with seed zero, a fast non-cryptographic hash, using SSE2
+// on x64. Matches the output of the reference xxHash library.
+class Xxh3 final {
+public:
+	Xxh3() { reset(); }
+	Xxh3(const Xxh3&) = default;
+	Xxh3(Xxh3&&) = default;
+	Xxh3& operator=(const Xxh3&) = default;
+	Xxh3& operator=(Xxh3&&) = default;
+
+	[[nodiscard]] uint64_t digest() const;
+	Xxh3& reset();
+	Xxh3& update(std::span<const BYTE> data);
+
+private:
+	static constexpr size_t _BUF_SZ = 256; // 4 stripes
+
+	alignas(16) std::array<uint64_t, 8> _acc;
+	std::array<BYTE, _BUF_SZ> _buf;
+	size_t _bufLen = 0;
+	size_t _numStripes = 0; // stripes consumed in the current block
+	uint64_t _totalLen = 0;
+};
+
+// Streaming SHA-256, using the SHA extensions when available.
+class Sha256 final {
+public:
+	Sha256() { reset(); }
+	Sha256(const Sha256&) = default;
+	Sha256(Sha256&&) = default;
+	Sha256& operator=(const Sha256&) = default;
+	Sha256& operator=(Sha256&&) = default;
+
+	[[nodiscard]] std::array<BYTE, 32> digest() const;
+	Sha256& reset();
+	Sha256& update(std::span<const BYTE> data);
+
+private:
+	std::array<uint32_t, 8> _state;
+	std::array<BYTE, 64> _buf;
+	size_t _bufLen = 0;
+	uint64_t _totalLen = 0;
+};
+
+// Streaming hasher of any Algo, so the algorithm can be chosen at runtime.
+// Example:
+// hash::Hasher h{hash::Algo::Sha256};
+// file.readChunks(File::CHUNK_SIZE, [&](std::span<BYTE> chunk) { h.update(chunk); });
+// std::wstring hex = h.digest().hex();
+class Hasher final {
+public:
+	Hasher(const Hasher&) = default;
+	Hasher(Hasher&&) = default;
+	Hasher& operator=(const Hasher&) = default;
+	Hasher& operator=(Hasher&&) = default;
+
+	explicit Hasher(Algo algo);
+
+	[[nodiscard]] Algo algo() const { return static_cast<Algo>(_h.index()); } // alternatives in Algo order
+	[[nodiscard]] Digest digest() const;
+	Hasher& reset();
+	Hasher& update(std::span<const BYTE> data);
+
+private:
+	std::variant<Crc32c, Xxh3, Sha256> _h;
+};
+
+// Hashes the whole file. Small files are read at once; larger ones are mapped
+// one window at a time, prefetching the next.
+[[nodiscard]] Digest hashFile(std::wstring_view path, Algo algo);
+
+// Hashes all files in parallel. If a file can't be read, its digest is std::nullopt;
+// any other error, like std::bad_alloc, is rethrown after all files are done.
+[[nodiscard]] std::vector<std::optional<Digest>> hashFiles(std::span<const std::wstring> paths, Algo algo);
+
+}
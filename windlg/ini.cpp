@@ -1,5 +1,4 @@
 #include <stdexcept>
-#include <Windows.h>
 #include "File.h"
 #include "ini.h"
 #include "str.h"
@@ -11,7 +10,7 @@ const std::wstring& Ini::Section::get(std::wstring_view key) const
 		if (str::eq(key, kv.key))
 			return kv.val;
 	}
-	throw std::out_of_range( str::toAnsi(str::fmt(L"Key not found: %s / %s", name, key)) );
+	throw std::out_of_range( str::toAnsi(str::fmt(L"Key not found: %ls / %ls", name, key)) );
 }
 
 int Ini::Section::getInt(std::wstring_view key) const
@@ -27,7 +26,7 @@ void Ini::Section::set(std::wstring_view key, std::wstring_view val)
 			return;
 		}
 	}
-	throw std::out_of_range( str::toAnsi(str::fmt(L"Key not found: %s / %s", name, key)) );
+	throw std::out_of_range( str::toAnsi(str::fmt(L"Key not found: %ls / %ls", name, key)) );
 }
 
 void Ini::Section::setInt(std::wstring_view key, int val)
@@ -42,7 +41,7 @@ const std::wstring& Ini::get(std::wstring_view section, std::wstring_view key) c
 		if (str::eq(section, s.name))
 			return s.get(key);
 	}
-	throw std::out_of_range( str::toAnsi(str::fmt(L"Section not found: %s", section)) );
+	throw std::out_of_range( str::toAnsi(str::fmt(L"Section not found: %ls", section)) );
 }
 
 int Ini::getInt(std::wstring_view section, std::wstring_view key) const
@@ -131,7 +130,7 @@ void Ini::set(std::wstring_view section, std::wstring_view key, std::wstring_vie
 			return;
 		}
 	}
-	throw std::out_of_range( str::toAnsi(str::fmt(L"Section not found: %s", section)) );
+	throw std::out_of_range( str::toAnsi(str::fmt(L"Section not found: %ls", section)) );
 }
 
 void Ini::setInt(std::wstring_view section, std::wstring_view key, int val)
@@ -2,7 +2,7 @@
 #include <optional>
 #include <string>
 #include <vector>
-#include <Windows.h>
+#include "sys.h"
 
 namespace lib {
 
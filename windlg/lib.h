@@ -3,6 +3,8 @@
 // https://github.com/rodrigocfd/windlg
 
 #pragma once
+#include "Arena.h"
+#include "AsyncFile.h"
 #include "CheckRadio.h"
 #include "Com.h"
 #include "ComboBox.h"
@@ -12,6 +14,9 @@
 #include "DialogModal.h"
 #include "dpi.h"
 #include "File.h"
+#include "FileCache.h"
+#include "FlatMap.h"
+#include "hash.h"
 #include "ImgList.h"
 #include "ini.h"
 #include "ListView.h"
@@ -19,6 +24,8 @@
 #include "NativeControl.h"
 #include "path.h"
 #include "ProgressBar.h"
+#include "Ring.h"
+#include "SoA.h"
 #include "StatusBar.h"
 #include "str.h"
 #include "TimeCount.h"
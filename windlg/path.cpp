@@ -1,14 +1,244 @@
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
 #include <system_error>
+#include <thread>
 #include "path.h"
 #include "str.h"
+#include "vec.h"
 using namespace lib;
 using namespace lib::path;
 
+DirIterator::DirIterator(std::wstring_view pathAndFilter, bool recursive) : _recursive{recursive}
+{
+	size_t idxSep = pathAndFilter.find_last_of(SEPARATOR);
+	if (idxSep == std::wstring::npos) [[unlikely]] {
+		throw std::logic_error("No separator in path " + str::toAnsi(pathAndFilter));
+	}
+	_dir = pathAndFilter.substr(0, idxSep + 1);
+	_open(pathAndFilter.substr(idxSep + 1));
+}
+
+DirIterator& DirIterator::operator=(DirIterator&& other) noexcept
+{
+	close();
+#ifdef _WIN32
+	std::swap(_hFind, other._hFind);
+	std::swap(_pending, other._pending);
+#else
+	std::swap(_hDir, other._hDir);
+	std::swap(_filter, other._filter);
+#endif
+	std::swap(_dir, other._dir);
+	std::swap(_entry, other._entry);
+	std::swap(_hasEntry, other._hasEntry);
+	std::swap(_recursive, other._recursive);
+	std::swap(_subdirs, other._subdirs);
+	return *this;
+}
+
+bool DirIterator::next()
+{
+	for (;;) {
+		DirIterator& cur = _subdirs.empty() ? *this : _subdirs.back();
+		if (!cur._fetch()) {
+			if (_subdirs.empty()) {
+				_hasEntry = false;
+				return false;
+			}
+			_subdirs.pop_back(); // this subfolder is done, back to its parent
+			continue;
+		}
+
+		if (&cur != this)
+			std::swap(_entry, cur._entry); // both buffers are reused
+		if (_recursive && _entry.isDir()) {
+			if (!_entry.isLink()) {
+				std::wstring subPath{_entry.path};
+				subPath.append({SEPARATOR, L'*'});
+				_subdirs.emplace_back(subPath); // folders aren't returned, just descended
+			}
+		} else {
+			_hasEntry = true;
+			return true;
+		}
+	}
+}
+
+Matcher& Matcher::addExtension(std::wstring_view ext)
+{
+	if (!ext.empty() && ext[0] == L'.')
+		ext.remove_prefix(1);
+	_exts.emplace(str::toUpper(ext));
+	return *this;
+}
+
+Matcher& Matcher::addGlob(std::wstring_view glob)
+{
+	std::wstring g = str::toUpper(glob);
+	if (g == L"*") {
+		_matchAll = true;
+		return *this;
+	}
+	if (g.length() > 2 && g.starts_with(L"*.")
+			&& g.find_first_of(L"*?[/\\", 1) == std::wstring::npos) { // just an extension
+		_exts.emplace(g.substr(2));
+		return *this;
+	}
+
+	std::vector<Token> tokens;
+	bool wholePath = false;
+	for (size_t i = 0; i < g.length(); ++i) {
+		Token token;
+		if (g[i] == L'/' || g[i] == L'\\') { // both accepted on any platform, so globs are portable
+			token.ch = SEPARATOR;
+			wholePath = true;
+		} else if (g[i] == L'*') {
+			token.kind = Token::Kind::Star;
+			if (i + 1 < g.length() && g[i + 1] == L'*') {
+				token.kind = Token::Kind::DoubleStar;
+				while (i + 1 < g.length() && g[i + 1] == L'*')
+					++i;
+				token.skipsSep = i + 1 < g.length() && (g[i + 1] == L'/' || g[i + 1] == L'\\');
+			}
+		} else if (g[i] == L'?') {
+			token.kind = Token::Kind::AnyChar;
+		} else if (g[i] == L'[') {
+			size_t c = i + 1;
+			bool negated = c < g.length() && (g[c] == L'!' || g[c] == L'^');
+			if (negated) ++c;
+			size_t idxClose = g.find(L']', c + 1); // a ] right after [ or [! is a char
+			if (idxClose == std::wstring::npos) {
+				token.ch = L'['; // unclosed, just a char
+			} else {
+				token.kind = Token::Kind::Class;
+				token.negated = negated;
+				for (; c < idxClose; ++c) {
+					if (c + 2 < idxClose && g[c + 1] == L'-') { // a range, like a-z
+						token.ranges.append({g[c], g[c + 2]});
+						c += 2;
+					} else {
+						token.ranges.append({g[c], g[c]});
+					}
+				}
+				i = idxClose;
+			}
+		} else {
+			token.ch = g[i];
+		}
+		tokens.emplace_back(std::move(token));
+	}
+	tokens.push_back({.kind = Token::Kind::Final});
+
+	if (tokens.size() > 64) [[unlikely]] { // each state is a bit, plus the final one
+		throw std::invalid_argument("Glob must have less than 64 chars, wildcards or classes.");
+	}
+
+	auto nfa = std::find_if(_nfas.begin(), _nfas.end(), [&](const Nfa& nfa) {
+		return nfa.wholePath == wholePath && nfa.tokens.size() + tokens.size() <= 64;
+	});
+	if (nfa == _nfas.end()) // no room left, another pass will be needed
+		nfa = _nfas.insert(_nfas.end(), Nfa{.wholePath = wholePath});
+
+	size_t base = nfa->tokens.size();
+	nfa->starts |= UINT64{1} << base;
+	nfa->finals |= UINT64{1} << (base + tokens.size() - 1);
+	for (size_t i = 0; i < tokens.size(); ++i) {
+		if (tokens[i].kind == Token::Kind::Star || tokens[i].kind == Token::Kind::DoubleStar)
+			nfa->stars |= UINT64{1} << (base + i);
+	}
+	std::move(tokens.begin(), tokens.end(), std::back_inserter(nfa->tokens));
+	return *this;
+}
+
+bool Matcher::matches(std::wstring_view p) const
+{
+	if (_matchAll) return true;
+
+	std::array<BYTE, 1024> stackBuf; // most paths fit, so uppercasing allocates nothing
+	std::pmr::monotonic_buffer_resource mem{stackBuf.data(), stackBuf.size()};
+	std::pmr::wstring upper = str::toUpper(&mem, p);
+	std::wstring_view full = upper;
+	std::wstring_view name = full.substr(full.find_last_of(SEPARATOR) + 1); // npos + 1 is zero
+
+	if (!_exts.empty()) {
+		for (size_t idxDot = name.find(L'.'); idxDot != std::wstring_view::npos; idxDot = name.find(L'.', idxDot + 1)) {
+			if (_exts.contains(name.substr(idxDot + 1))) // so multi-dot extensions, like "tar.gz", are found too
+				return true;
+		}
+	}
+	for (const Nfa& nfa : _nfas) {
+		if (_Run(nfa, nfa.wholePath ? full : name))
+			return true;
+	}
+	return false;
+}
+
+// Simulates the NFA, with one bit for each state, all of them advancing on each char.
+bool Matcher::_Run(const Nfa& nfa, std::wstring_view s)
+{
+	const std::vector<Token>& tokens = nfa.tokens;
+	auto closure = [&](UINT64 states) -> UINT64 { // stars can match nothing
+		for (UINT64 pending = states & nfa.stars; pending; pending &= pending - 1) {
+			size_t i = std::countr_zero(pending);
+			UINT64 added = UINT64{1} << (i + 1);
+			if (tokens[i].skipsSep)
+				added |= UINT64{1} << (i + 2);
+			added &= ~states;
+			states |= added;
+			pending |= added & nfa.stars; // always above i, so still ahead in the loop
+		}
+		return states;
+	};
+
+	UINT64 states = closure(nfa.starts);
+	for (WCHAR c : s) {
+		UINT64 next = 0;
+		for (UINT64 pending = states; pending; pending &= pending - 1) {
+			size_t i = std::countr_zero(pending);
+			const Token& token = tokens[i];
+			switch (token.kind) {
+			case Token::Kind::Char:
+				if (c == token.ch) next |= UINT64{1} << (i + 1);
+				break;
+			case Token::Kind::AnyChar:
+				if (c != SEPARATOR) next |= UINT64{1} << (i + 1);
+				break;
+			case Token::Kind::Class:
+				if (c != SEPARATOR) {
+					bool inRanges = false;
+					for (size_t r = 0; r < token.ranges.length() && !inRanges; r += 2)
+						inRanges = c >= token.ranges[r] && c <= token.ranges[r + 1];
+					if (inRanges != token.negated) next |= UINT64{1} << (i + 1);
+				}
+				break;
+			case Token::Kind::Star:
+				if (c != SEPARATOR) next |= UINT64{1} << i;
+				break;
+			case Token::Kind::DoubleStar:
+				next |= UINT64{1} << i;
+				break;
+			case Token::Kind::Final: // a glob matched all it could, nothing to advance
+				break;
+			}
+		}
+		states = closure(next);
+		if (!states) return false;
+	}
+	return states & nfa.finals;
+}
+
 std::wstring lib::path::dirFrom(std::wstring_view p)
 {
 	std::wstring ret{p};
-	size_t found = ret.find_last_of(L'\\'); // won't include trailing backslash
+	size_t found = ret.find_last_of(SEPARATOR); // won't include trailing separator
 	if (found != std::wstring::npos)
 		ret.resize(found);
 	return ret;
@@ -16,70 +246,333 @@ std::wstring lib::path::dirFrom(std::wstring_view p)
 
 std::vector<std::wstring> lib::path::dirList(std::wstring_view pathAndFilter)
 {
-	WIN32_FIND_DATAW wfd{};
-	HANDLE hFind = FindFirstFileW(pathAndFilter.data(), &wfd);
-	if (hFind == INVALID_HANDLE_VALUE) {
-		DWORD err = GetLastError();
-		FindClose(hFind);
-		if (err == ERROR_FILE_NOT_FOUND) [[likely]] {
-			return {}; // no files found
-		} else [[unlikely]] {
-			throw std::system_error(err, std::system_category(), "FindFirstFile failed");
-		}
+	std::vector<DirEntry> entries = dirListEntries(pathAndFilter);
+	std::vector<std::wstring> paths;
+	paths.reserve(entries.size());
+	for (DirEntry& entry : entries)
+		paths.emplace_back(std::move(entry.path));
+	return paths;
+}
+
+std::vector<std::wstring> lib::path::dirList(std::wstring_view dir, const Matcher& matcher)
+{
+	std::wstring pathAndFilter{dir};
+	trimBackslash(pathAndFilter);
+	pathAndFilter.append({SEPARATOR, L'*'});
+
+	std::vector<DirEntry> entries;
+	for (DirEntry& entry : DirIterator{pathAndFilter}) {
+		if (matcher.matches(entry.path))
+			entries.emplace_back(std::move(entry));
 	}
+	sortEntries(entries);
 
-	std::vector<std::wstring> entries;
-	for (;;) {
-		if (!str::eq(wfd.cFileName, L".") && !str::eq(wfd.cFileName, L"..")) { // skip these
-			size_t idxBackslash = pathAndFilter.find_last_of(L"\\");
-			if (idxBackslash != std::wstring::npos) [[likely]] {
-				std::wstring fullPath{pathAndFilter.substr(0, idxBackslash + 1)};
-				fullPath.append(wfd.cFileName);
-				entries.emplace_back(std::move(fullPath));
-			} else [[unlikely]] {
-				std::wstring faultyPath{wfd.cFileName};
-				throw std::logic_error("No backslash in found file " + str::toAnsi(faultyPath));
-			}
-		}
+	std::vector<std::wstring> paths;
+	paths.reserve(entries.size());
+	for (DirEntry& entry : entries)
+		paths.emplace_back(std::move(entry.path));
+	return paths;
+}
+
+std::vector<DirEntry> lib::path::dirListEntries(std::wstring_view pathAndFilter)
+{
+	std::vector<DirEntry> entries;
+	for (DirEntry& entry : DirIterator{pathAndFilter})
+		entries.emplace_back(std::move(entry));
+	sortEntries(entries);
+	return entries;
+}
+
+#ifdef _WIN32
+static UINT64 _fileTime(const FILETIME& ft)
+{
+	return (UINT64{ft.dwHighDateTime} << 32) | ft.dwLowDateTime;
+}
+
+void DirIterator::close() noexcept
+{
+	if (_hFind) {
+		FindClose(_hFind);
+		_hFind = nullptr;
+	}
+	_pending = false;
+	_hasEntry = false;
+	_subdirs.clear();
+}
+
+// Fills the entry from the listing, returning false for "." and "..", which are skipped.
+static bool _fromFindData(const WIN32_FIND_DATAW& wfd, std::wstring_view dir, DirEntry& entry)
+{
+	if (str::eq(wfd.cFileName, L".") || str::eq(wfd.cFileName, L".."))
+		return false;
+
+	entry.path.assign(dir); // reuses the buffer of the previous entry
+	entry.path.append(wfd.cFileName);
+	entry.attributes = wfd.dwFileAttributes;
+	entry.size = (UINT64{wfd.nFileSizeHigh} << 32) | wfd.nFileSizeLow;
+	entry.creationTime = _fileTime(wfd.ftCreationTime);
+	entry.lastAccessTime = _fileTime(wfd.ftLastAccessTime);
+	entry.lastWriteTime = _fileTime(wfd.ftLastWriteTime);
+	return true;
+}
 
-		if (!FindNextFileW(hFind, &wfd)) {
+bool DirIterator::_fetch()
+{
+	if (_pending) {
+		_pending = false;
+		return true;
+	}
+
+	WIN32_FIND_DATAW wfd{};
+	while (_hFind) {
+		if (!FindNextFileW(_hFind, &wfd)) {
 			DWORD err = GetLastError();
-			FindClose(hFind);
+			FindClose(_hFind);
+			_hFind = nullptr;
 			if (err == ERROR_NO_MORE_FILES) [[likely]] {
-				std::sort(entries.begin(), entries.end(), [](const std::wstring& a, const std::wstring& b) -> bool {
-					return lstrcmpiW(a.c_str(), b.c_str()) < 1;
-				});
-				return entries; // no more files found
+				return false;
 			} else [[unlikely]] {
 				throw std::system_error(err, std::system_category(), "FindNextFile failed");
 			}
 		}
+		if (_fromFindData(wfd, _dir, _entry))
+			return true;
+	}
+	return false;
+}
+
+void DirIterator::_open(std::wstring_view filter)
+{
+	std::wstring pathAndFilter = _dir;
+	pathAndFilter.append(filter);
+
+	// Basic info skips the 8.3 short names, which DirEntry doesn't have, and large
+	// fetch reads the directory in bigger batches, so there are fewer kernel calls.
+	WIN32_FIND_DATAW wfd{};
+	HANDLE hFind = FindFirstFileExW(pathAndFilter.c_str(), FindExInfoBasic, &wfd,
+		FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		DWORD err = GetLastError();
+		if (err == ERROR_FILE_NOT_FOUND) [[likely]] {
+			return; // no files found
+		} else [[unlikely]] {
+			throw std::system_error(err, std::system_category(), "FindFirstFileEx failed");
+		}
 	}
+	_hFind = hFind;
+	_pending = _fromFindData(wfd, _dir, _entry);
 }
+#endif
 
-void _dirWalkBuf(std::wstring_view pathAndFilter, std::vector<std::wstring>& outBuf)
+static void _dirWalkBuf(std::wstring_view pathAndFilter, std::vector<DirEntry>& outBuf,
+	const Matcher* pMatcher = nullptr)
 {
-	std::vector<std::wstring> entries = dirList(pathAndFilter);
-	for (const auto& entry : entries) {
-		if (!isDir(entry))
-			outBuf.push_back(entry);
+	std::vector<DirEntry> entries = dirListEntries(pathAndFilter);
+	for (DirEntry& entry : entries) {
+		if (!entry.isDir() // attributes came with the listing, no need to query again
+				&& (!pMatcher || pMatcher->matches(entry.path)))
+			outBuf.emplace_back(std::move(entry));
 	}
-	for (const auto& entry : entries) {
-		if (isDir(entry)) {
-			std::wstring subPath{entry};
-			subPath.append(L"\\*");
-			_dirWalkBuf(subPath, outBuf); // recursively, deep last
+	for (const DirEntry& entry : entries) {
+		if (entry.isDir() && !entry.isLink()) { // a linked folder could lead back to its parent
+			std::wstring subPath{entry.path};
+			subPath.append({SEPARATOR, L'*'});
+			_dirWalkBuf(subPath, outBuf, pMatcher); // recursively, deep last
 		}
 	}
 }
 
 std::vector<std::wstring> lib::path::dirWalk(std::wstring_view pathAndFilter)
 {
-	std::vector<std::wstring> entries;
+	std::vector<DirEntry> entries = dirWalkEntries(pathAndFilter);
+	std::vector<std::wstring> paths;
+	paths.reserve(entries.size());
+	for (DirEntry& entry : entries)
+		paths.emplace_back(std::move(entry.path));
+	return paths;
+}
+
+std::vector<std::wstring> lib::path::dirWalk(std::wstring_view dir, const Matcher& matcher)
+{
+	std::wstring pathAndFilter{dir};
+	trimBackslash(pathAndFilter);
+	pathAndFilter.append({SEPARATOR, L'*'});
+
+	std::vector<DirEntry> entries;
+	_dirWalkBuf(pathAndFilter, entries, &matcher);
+	std::vector<std::wstring> paths;
+	paths.reserve(entries.size());
+	for (DirEntry& entry : entries)
+		paths.emplace_back(std::move(entry.path));
+	return paths;
+}
+
+std::vector<DirEntry> lib::path::dirWalkEntries(std::wstring_view pathAndFilter)
+{
+	std::vector<DirEntry> entries;
 	_dirWalkBuf(pathAndFilter, entries);
 	return entries;
 }
 
+struct WalkNode final { // a folder, kept to rebuild the sorted order
+	std::vector<DirEntry> files;
+	std::vector<std::unique_ptr<WalkNode>> subdirs;
+};
+
+struct WalkTask final {
+	std::wstring dir;
+	size_t depth = 0;
+	WalkNode* node = nullptr;
+};
+
+struct WalkWorker final {
+	std::mutex mtx;
+	std::deque<WalkTask> tasks; // the owner pops from the back, thieves from the front
+	std::vector<DirEntry> found; // unsorted results
+};
+
+struct ParallelWalk final {
+	const WalkOptions& options;
+	const Matcher& matcher;
+	std::vector<WalkWorker> workers;
+	std::mutex mtx{}; // guards all the fields below
+	std::condition_variable cv{};
+	size_t numQueued = 0; // tasks waiting in any worker
+	size_t numPending = 0; // tasks queued or running; when zero, the walk is done
+	std::exception_ptr err{};
+	std::mutex cbMtx{}; // serializes onEntry calls
+
+	void push(size_t workerIdx, WalkTask task) {
+		{
+			std::lock_guard lock{mtx}; // counted before it's visible, so a thief can't finish it first
+			++numQueued;
+			++numPending;
+		}
+		{
+			std::lock_guard lock{workers[workerIdx].mtx};
+			workers[workerIdx].tasks.emplace_back(std::move(task));
+		}
+		cv.notify_one();
+	}
+
+	[[nodiscard]] bool tryPop(size_t workerIdx, WalkTask& task) {
+		for (size_t i = 0; i < workers.size(); ++i) {
+			WalkWorker& victim = workers[(workerIdx + i) % workers.size()]; // own deque first
+			std::lock_guard lock{victim.mtx};
+			if (!victim.tasks.empty()) {
+				if (i == 0) { // newest own folder, deepest first, while its parent is still cached
+					task = std::move(victim.tasks.back());
+					victim.tasks.pop_back();
+				} else { // oldest of another worker, likely the root of a large subtree
+					task = std::move(victim.tasks.front());
+					victim.tasks.pop_front();
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void run(size_t workerIdx) {
+		for (;;) {
+			WalkTask task;
+			if (tryPop(workerIdx, task)) {
+				{
+					std::lock_guard lock{mtx};
+					--numQueued;
+				}
+				process(workerIdx, task);
+				std::lock_guard lock{mtx};
+				if (--numPending == 0)
+					cv.notify_all();
+			} else {
+				std::unique_lock lock{mtx};
+				if (!numPending) return;
+				cv.wait(lock, [&]() { return numQueued || !numPending; });
+			}
+		}
+	}
+
+	void process(size_t workerIdx, WalkTask& task) {
+		if (options.stopToken.stop_requested()) return; // just drain the queues
+		{
+			std::lock_guard lock{mtx};
+			if (err) return;
+		}
+
+		try {
+			std::wstring pathAndFilter = task.dir;
+			pathAndFilter.append({SEPARATOR, L'*'});
+			for (DirEntry& entry : dirListEntries(pathAndFilter)) {
+				if (entry.isDir()) {
+					if (task.depth < options.maxDepth && !entry.isLink()) { // a linked folder could loop
+						WalkNode* child = nullptr;
+						if (task.node)
+							child = task.node->subdirs.emplace_back(std::make_unique<WalkNode>()).get();
+						push(workerIdx, {.dir = std::move(entry.path), .depth = task.depth + 1, .node = child});
+					}
+				} else if (matcher.matches(entry.path)) {
+					if (options.onEntry) {
+						std::lock_guard lock{cbMtx};
+						options.onEntry(entry);
+					} else if (task.node) {
+						task.node->files.emplace_back(std::move(entry));
+					} else {
+						workers[workerIdx].found.emplace_back(std::move(entry));
+					}
+				}
+			}
+		} catch (...) {
+			std::lock_guard lock{mtx};
+			if (!err) err = std::current_exception(); // the first error aborts the walk
+		}
+	}
+};
+
+static void _flattenWalk(WalkNode& node, std::vector<DirEntry>& outBuf)
+{
+	std::move(node.files.begin(), node.files.end(), std::back_inserter(outBuf));
+	for (auto& subdir : node.subdirs)
+		_flattenWalk(*subdir, outBuf); // same order as _dirWalkBuf()
+}
+
+std::vector<DirEntry> lib::path::dirWalkParallel(std::wstring_view root,
+	std::wstring_view filter, const WalkOptions& options)
+{
+	size_t numThreads = options.numThreads ? options.numThreads
+		: std::max(4u, std::thread::hardware_concurrency());
+	Matcher matcher{filter};
+	ParallelWalk walk{.options = options, .matcher = matcher, .workers = std::vector<WalkWorker>(numThreads)};
+
+	WalkNode rootNode;
+	std::wstring rootDir{root};
+	trimBackslash(rootDir);
+	walk.push(0, {.dir = std::move(rootDir), .depth = 0,
+		.node = (options.sorted && !options.onEntry) ? &rootNode : nullptr});
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < numThreads; ++i)
+		threads.emplace_back([&walk, i]() { walk.run(i); });
+	for (std::thread& t : threads)
+		t.join();
+
+	if (walk.err) [[unlikely]] {
+		std::rethrow_exception(walk.err);
+	}
+
+	std::vector<DirEntry> entries;
+	if (options.onEntry) {
+		// already delivered
+	} else if (options.sorted) {
+		_flattenWalk(rootNode, entries);
+	} else {
+		for (WalkWorker& worker : walk.workers)
+			std::move(worker.found.begin(), worker.found.end(), std::back_inserter(entries));
+	}
+	return entries;
+}
+
+#ifdef _WIN32
 std::wstring lib::path::exeDir()
 {
 	WCHAR buf[MAX_PATH] = {L'\0'};
@@ -96,11 +589,12 @@ bool lib::path::exists(std::wstring_view p)
 	DWORD attr = GetFileAttributesW(p.data());
 	return attr != INVALID_FILE_ATTRIBUTES;
 }
+#endif
 
 std::wstring lib::path::fileFrom(std::wstring_view p)
 {
 	std::wstring ret{p};
-	size_t found = ret.find_last_of(L'\\');
+	size_t found = ret.find_last_of(SEPARATOR);
 	if (found != std::wstring::npos)
 		ret.erase(0, found + 1);
 	return ret;
@@ -120,6 +614,7 @@ bool lib::path::hasExtension(std::wstring_view p, std::initializer_list<std::wst
 	return false;
 }
 
+#ifdef _WIN32
 static DWORD _getAttrs(std::wstring_view p)
 {
 	DWORD attr = GetFileAttributesW(p.data());
@@ -143,6 +638,13 @@ bool lib::path::isReadOnly(std::wstring_view p)
 {
 	return _getAttrs(p) & FILE_ATTRIBUTE_READONLY;
 }
+#endif
+
+void lib::path::sortEntries(std::vector<DirEntry>& entries)
+{
+	vec::sortBy(entries, [](const DirEntry& e) -> std::wstring_view { return e.path; },
+		[](std::wstring_view a, std::wstring_view b) -> bool { return str::cmpI(a, b) < 0; });
+}
 
 std::wstring lib::path::swapExtension(std::wstring_view p, std::wstring newExt)
 {
@@ -157,6 +659,6 @@ std::wstring lib::path::swapExtension(std::wstring_view p, std::wstring newExt)
 
 void lib::path::trimBackslash(std::wstring& p)
 {
-	while (p.back() == L'\\')
+	while (!p.empty() && p.back() == SEPARATOR)
 		p.resize(p.length() - 1);
 }
@@ -1,19 +1,213 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
-#include <Windows.h>
+#include "sys.h"
 
 namespace lib::path {
 
+// Separator between path components: backslash on Windows, slash on POSIX.
+#ifdef _WIN32
+constexpr WCHAR SEPARATOR = L'\\';
+#else
+constexpr WCHAR SEPARATOR = L'/';
+#endif
+
+// File or folder returned by DirIterator, dirListEntries() and dirWalkEntries(), filled straight
+// from the directory listing, so no further queries are needed.
+struct DirEntry final {
+	std::wstring path; // full path
+	DWORD attributes = 0; // FILE_ATTRIBUTE_ flags; on POSIX, only DIRECTORY, HIDDEN, READONLY, REPARSE_POINT or NORMAL
+	UINT64 size = 0;
+	UINT64 creationTime = 0; // all times in 100-nanosecond intervals since 1601 UTC, like FILETIME
+	UINT64 lastAccessTime = 0;
+	UINT64 lastWriteTime = 0;
+
+	[[nodiscard]] constexpr bool isDir() const { return attributes & FILE_ATTRIBUTE_DIRECTORY; }
+	[[nodiscard]] constexpr bool isHidden() const { return attributes & FILE_ATTRIBUTE_HIDDEN; }
+	[[nodiscard]] constexpr bool isReadOnly() const { return attributes & FILE_ATTRIBUTE_READONLY; }
+	// Symbolic link or junction; the walks don't descend into linked folders, which could loop.
+	[[nodiscard]] constexpr bool isLink() const { return attributes & FILE_ATTRIBUTE_REPARSE_POINT; }
+	// Returns the file name, without the folder.
+	[[nodiscard]] std::wstring_view name() const {
+		size_t idxSep = path.find_last_of(SEPARATOR);
+		return (idxSep == std::wstring::npos) ? path : std::wstring_view{path}.substr(idxSep + 1);
+	}
+};
+
+// Lazily lists the files and folders within pathAndFilter, like dirListEntries(),
+// but fetching each entry only when asked, unsorted. On huge folders, the first
+// entries are available right away, and the listing can stop at any time. If
+// recursive, returns the files of all subfolders too, like dirWalkEntries(); linked
+// folders are skipped.
+// Example:
+// for (path::DirEntry& entry : path::DirIterator{L"C:\\Temp\\*.mp3"})
+//     mp3s.emplace_back(std::move(entry.path));
+class DirIterator final {
+public:
+	// Input iterator returned by begin(); each increment fetches the next entry,
+	// so the range can be traversed only once.
+	class Iter final {
+	public:
+		using iterator_concept = std::input_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = DirEntry;
+
+		constexpr Iter() = default;
+		constexpr explicit Iter(DirIterator* pOwner) : _pOwner{pOwner} { }
+
+		[[nodiscard]] DirEntry& operator*() const { return _pOwner->_entry; }
+		[[nodiscard]] DirEntry* operator->() const { return &_pOwner->_entry; }
+		Iter& operator++() { _pOwner->next(); return *this; }
+		void operator++(int) { _pOwner->next(); }
+		[[nodiscard]] bool operator==(std::default_sentinel_t) const { return !_pOwner->_hasEntry; }
+
+	private:
+		DirIterator* _pOwner = nullptr;
+	};
+
+	~DirIterator() { close(); }
+
+	constexpr DirIterator() = default;
+	DirIterator(const DirIterator&) = delete;
+	DirIterator(DirIterator&& other) noexcept { operator=(std::forward<DirIterator>(other)); }
+	DirIterator& operator=(const DirIterator&) = delete;
+	DirIterator& operator=(DirIterator&& other) noexcept;
+
+	explicit DirIterator(std::wstring_view pathAndFilter, bool recursive = false);
+
+	// Fetches the first entry.
+	[[nodiscard]] Iter begin() { next(); return Iter{this}; }
+	void close() noexcept;
+	[[nodiscard]] constexpr std::default_sentinel_t end() const { return std::default_sentinel; }
+	// Current entry; it can be moved from, since next() overwrites it.
+	[[nodiscard]] DirEntry& entry() { return _entry; }
+	// Fetches the next entry, returning false if there are no more.
+	bool next();
+
+private:
+	[[nodiscard]] bool _fetch();
+	void _open(std::wstring_view filter);
+
+#ifdef _WIN32
+	HANDLE _hFind = nullptr;
+	bool _pending = false; // FindFirstFileEx() already returned the first entry
+#else
+	LPVOID _hDir = nullptr; // DIR*
+	std::string _filter; // UTF-8, for fnmatch()
+#endif
+	std::wstring _dir; // with the trailing separator
+	DirEntry _entry;
+	bool _hasEntry = false;
+	bool _recursive = false;
+	std::vector<DirIterator> _subdirs; // if recursive, the folders being listed, innermost last
+};
+
+// Set of globs and extensions, compiled once, which matches paths case-insensitive.
+// Globs accept ? and * (any chars but separators), ** (any chars, including
+// separators, so "**\\" also matches no folder at all) and classes like [a-z] or
+// [!0-9]. Separators can be written as / or \\ on any platform. A glob without
+// separators matches the file name only, otherwise the whole path. Extensions,
+// and globs like "*.mp3", are looked up in a hash set. The other globs are merged
+// into one NFA, one bit per state, which advances all of them in a single pass
+// over the name; globs of whole paths take another pass, and each 64 states add
+// one more.
+// Example:
+// path::Matcher music{L"*.mp3", L"*.flac", L"**\\Live\\*.wav"};
+// std::vector<std::wstring> files = path::dirWalk(L"D:\\Music", music);
+class Matcher final {
+public:
+	Matcher() = default;
+	Matcher(const Matcher&) = default;
+	Matcher(Matcher&&) = default;
+	Matcher& operator=(const Matcher&) = default;
+	Matcher& operator=(Matcher&&) = default;
+
+	explicit Matcher(std::initializer_list<std::wstring_view> globs) { for (std::wstring_view glob : globs) addGlob(glob); }
+
+	// Adds an extension, like ".mp3" or "mp3".
+	Matcher& addExtension(std::wstring_view ext);
+	// Adds a glob, like "*.mp3" or "**\\Music\\[a-c]*".
+	Matcher& addGlob(std::wstring_view glob);
+	// Returns true if p matches any of the globs or extensions.
+	[[nodiscard]] bool matches(std::wstring_view p) const;
+
+private:
+	struct Token final {
+		enum class Kind : BYTE { Char, AnyChar, Class, Star, DoubleStar, Final } kind = Kind::Char;
+		bool negated = false; // Class: matches chars not in ranges
+		bool skipsSep = false; // DoubleStar: followed by a separator, which can be skipped too
+		WCHAR ch = L'\0'; // Char
+		std::wstring ranges{}; // Class: pairs of first and last chars
+	};
+
+	struct Nfa final { // globs matched against the same part of the path, up to 64 states
+		std::vector<Token> tokens{}; // the states of each glob, then its final one
+		UINT64 starts = 0; // first state of each glob
+		UINT64 finals = 0;
+		UINT64 stars = 0; // states which can also be skipped
+		bool wholePath = false;
+	};
+
+	struct ExtHash final { // allows lookups by std::wstring_view
+		using is_transparent = void;
+		[[nodiscard]] size_t operator()(std::wstring_view s) const { return std::hash<std::wstring_view>{}(s); }
+	};
+
+	[[nodiscard]] static bool _Run(const Nfa& nfa, std::wstring_view s);
+
+	std::vector<Nfa> _nfas; // usually one for file names, and one for whole paths
+	std::unordered_set<std::wstring, ExtHash, std::equal_to<>> _exts; // uppercase, without the dot
+	bool _matchAll = false; // there's a lone * glob
+};
+
+// Options of dirWalkParallel().
+struct WalkOptions final {
+	size_t numThreads = 0; // zero means at least 4, since listing folders waits on I/O, not CPU
+	size_t maxDepth = SIZE_MAX; // folder levels below the root to descend; zero lists only the root
+	bool sorted = true; // same order as dirWalkEntries(), otherwise as found
+	std::function<void(const DirEntry&)> onEntry{}; // if set, receives each file as found, instead of the returned vector; calls are serialized, but come from worker threads
+	std::stop_token stopToken{}; // stops the walk, returning the files found so far
+};
+
 // Returns the full directory of p, without the trailing backslash.
 [[nodiscard]] std::wstring dirFrom(std::wstring_view p);
 
 // Returns all files and folders within pathAndFilter, like "C:\\Temp\\*.mp3" or "C:\\Temp\\*".
 [[nodiscard]] std::vector<std::wstring> dirList(std::wstring_view pathAndFilter);
 
+// Returns all files and folders within dir which match the matcher.
+[[nodiscard]] std::vector<std::wstring> dirList(std::wstring_view dir, const Matcher& matcher);
+
+// Returns all files and folders within pathAndFilter, like dirList(), along with
+// their attributes, sizes and times.
+[[nodiscard]] std::vector<DirEntry> dirListEntries(std::wstring_view pathAndFilter);
+
 // Returns, recursively on folders, all files within pathAndFilter, like "C:\\Temp\\*.mp3" or "C:\\Temp\\*".
 [[nodiscard]] std::vector<std::wstring> dirWalk(std::wstring_view pathAndFilter);
 
+// Returns, recursively on folders, all files within dir which match the matcher.
+[[nodiscard]] std::vector<std::wstring> dirWalk(std::wstring_view dir, const Matcher& matcher);
+
+// Returns, recursively on folders, all files within pathAndFilter, like dirWalk(),
+// along with their attributes, sizes and times.
+[[nodiscard]] std::vector<DirEntry> dirWalkEntries(std::wstring_view pathAndFilter);
+
+// Returns, recursively on folders, all files within root whose names match the
+// filter, like "*.mp3", case-insensitive, as a Matcher glob. The folders are listed by a pool of
+// threads, each one stealing pending folders from the others when idle.
+// Example:
+// std::vector<path::DirEntry> mp3s = path::dirWalkParallel(L"D:\\Music", L"*.mp3");
+[[nodiscard]] std::vector<DirEntry> dirWalkParallel(std::wstring_view root,
+	std::wstring_view filter = L"*", const WalkOptions& options = {});
+
 // Returns the path of the current executable. In debug mode, goes up another level, returning the project path.
 [[nodiscard]] std::wstring exeDir();
 
@@ -38,6 +232,9 @@ namespace lib::path {
 // Returns true if p is read-only.
 [[nodiscard]] bool isReadOnly(std::wstring_view p);
 
+// Sorts the entries by path, case-insensitive, like dirListEntries() does.
+void sortEntries(std::vector<DirEntry>& entries);
+
 // Swaps the extension of p by newExt.
 [[nodiscard]] std::wstring swapExtension(std::wstring_view p, std::wstring newExt);
 
@@ -0,0 +1,143 @@
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <system_error>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "path.h"
+#include "str.h"
+using namespace lib;
+using namespace lib::path;
+
+// POSIX backend of the path functions which query the file system; the Win32 one is in path.cpp.
+
+static std::wstring _fromNative(char* name)
+{
+	return str::parse(std::span{reinterpret_cast<BYTE*>(name), std::strlen(name)}); // usually UTF-8
+}
+
+// Converts to 100-nanosecond intervals since 1601 UTC, like FILETIME.
+static UINT64 _fileTime(const timespec& ts)
+{
+	constexpr UINT64 SECS_1601_TO_1970 = 11'644'473'600;
+	return (static_cast<UINT64>(ts.tv_sec) + SECS_1601_TO_1970) * 10'000'000 + ts.tv_nsec / 100;
+}
+
+void DirIterator::close() noexcept
+{
+	if (_hDir) {
+		closedir(static_cast<DIR*>(_hDir));
+		_hDir = nullptr;
+	}
+	_hasEntry = false;
+	_subdirs.clear();
+}
+
+bool DirIterator::_fetch()
+{
+	while (_hDir) {
+		DIR* hDir = static_cast<DIR*>(_hDir);
+		errno = 0; // readdir() returns null both at the end and on error
+		dirent* ent = readdir(hDir);
+		if (!ent) {
+			int err = errno;
+			closedir(hDir);
+			_hDir = nullptr;
+			if (err) [[unlikely]] {
+				throw std::system_error(err, std::generic_category(), "readdir failed");
+			}
+			return false;
+		}
+
+		if (!std::strcmp(ent->d_name, ".") || !std::strcmp(ent->d_name, "..")) // skip these
+			continue;
+		if (fnmatch(_filter.c_str(), ent->d_name, FNM_CASEFOLD)) // case-insensitive, like FindFirstFile()
+			continue;
+
+		// readdir() has no sizes or times; fstatat() is relative to the open
+		// directory, so the kernel doesn't resolve the full path again.
+		struct stat st{};
+		if (fstatat(dirfd(hDir), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1)
+			continue; // deleted since readdir()
+
+		DWORD attrs = 0;
+		if (S_ISLNK(st.st_mode)) { // the link itself, like FindFirstFile() reports a reparse point
+			attrs |= FILE_ATTRIBUTE_REPARSE_POINT;
+			struct stat target{};
+			if (fstatat(dirfd(hDir), ent->d_name, &target, 0) == 0 && S_ISDIR(target.st_mode))
+				attrs |= FILE_ATTRIBUTE_DIRECTORY; // a broken link is just reported as a file
+		}
+		if (S_ISDIR(st.st_mode)) attrs |= FILE_ATTRIBUTE_DIRECTORY;
+		if (ent->d_name[0] == '.') attrs |= FILE_ATTRIBUTE_HIDDEN; // dot files are hidden by convention
+		if (!(st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH))) attrs |= FILE_ATTRIBUTE_READONLY;
+
+		_entry.path.assign(_dir); // reuses the buffer of the previous entry
+		_entry.path.append(_fromNative(ent->d_name));
+		_entry.attributes = attrs ? attrs : FILE_ATTRIBUTE_NORMAL;
+		_entry.size = static_cast<UINT64>(st.st_size);
+		_entry.creationTime = _fileTime(st.st_ctim); // POSIX has no creation time, ctime is the closest
+		_entry.lastAccessTime = _fileTime(st.st_atim);
+		_entry.lastWriteTime = _fileTime(st.st_mtim);
+		return true;
+	}
+	return false;
+}
+
+void DirIterator::_open(std::wstring_view filter)
+{
+	_filter = str::toUtf8(filter);
+	_hDir = opendir(str::toUtf8(_dir).c_str());
+	if (!_hDir) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "opendir failed");
+	}
+}
+
+std::wstring lib::path::exeDir()
+{
+	char buf[PATH_MAX] = {'\0'};
+	if (readlink("/proc/self/exe", buf, ARRAYSIZE(buf) - 1) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "readlink failed");
+	}
+	std::wstring p = dirFrom(_fromNative(buf));
+#ifdef _DEBUG
+	p = dirFrom(p); // in debug mode, go up another dir level
+#endif
+	return p;
+}
+
+bool lib::path::exists(std::wstring_view p)
+{
+	struct stat st{};
+	return stat(str::toUtf8(p).c_str(), &st) == 0;
+}
+
+static struct stat _getStat(std::wstring_view p)
+{
+	struct stat st{};
+	if (stat(str::toUtf8(p).c_str(), &st) == -1) [[unlikely]] {
+		throw std::system_error(errno, std::generic_category(), "stat failed");
+	}
+	return st;
+}
+
+bool lib::path::isDir(std::wstring_view p)
+{
+	return S_ISDIR(_getStat(p).st_mode);
+}
+
+bool lib::path::isHidden(std::wstring_view p)
+{
+	_getStat(p); // throws if p doesn't exist, like the Win32 version
+	std::wstring name = fileFrom(p);
+	return !name.empty() && name[0] == L'.'; // dot files are hidden by convention
+}
+
+bool lib::path::isReadOnly(std::wstring_view p)
+{
+	return !(_getStat(p).st_mode & (S_IWUSR | S_IWGRP | S_IWOTH));
+}
+#endif
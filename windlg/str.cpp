@@ -1,17 +1,170 @@
 #include <algorithm>
+#include <cwchar>
 #include <cwctype>
 #include <stdexcept>
-#include <Windows.h>
 #include "str.h"
 
+// System primitives; everything else in this file is portable.
+#ifdef _WIN32
+static int _sysCmp(LPCWSTR a, LPCWSTR b)
+{
+	return lstrcmpW(a, b);
+}
+
+static int _sysCmpI(LPCWSTR a, LPCWSTR b)
+{
+	return lstrcmpiW(a, b);
+}
+
+static size_t _sysLen(LPCWSTR s)
+{
+	return lstrlenW(s);
+}
+
+static WCHAR _sysUpperChar(WCHAR ch)
+{
+	return static_cast<WCHAR>(reinterpret_cast<ULONG_PTR>(
+		CharUpperW(reinterpret_cast<LPWSTR>(static_cast<ULONG_PTR>(ch))) )); // single char mode
+}
+
+static void _sysLowerBuf(WCHAR* s, size_t len)
+{
+	CharLowerBuffW(s, static_cast<DWORD>(len));
+}
+
+static void _sysUpperBuf(WCHAR* s, size_t len)
+{
+	CharUpperBuffW(s, static_cast<DWORD>(len));
+}
+
+// Returns the number of chars decoded from src; they're written only if dest isn't empty.
+static size_t _sysDecode(std::span<BYTE> src, UINT codePage, std::span<WCHAR> dest)
+{
+	return MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(src.data()),
+		static_cast<int>(src.size()), dest.data(), static_cast<int>(dest.size()));
+}
+
+// Returns the number of UTF-8 bytes encoded from s; they're written only if dest isn't empty.
+static size_t _sysEncodeUtf8(std::wstring_view s, std::span<BYTE> dest)
+{
+	return WideCharToMultiByte(CP_UTF8, 0, s.data(), static_cast<int>(s.length()),
+		reinterpret_cast<char*>(dest.data()), static_cast<int>(dest.size()), nullptr, nullptr);
+}
+#else
+static int _sysCmp(LPCWSTR a, LPCWSTR b)
+{
+	return std::wcscmp(a, b);
+}
+
+static int _sysCmpI(LPCWSTR a, LPCWSTR b)
+{
+	return wcscasecmp(a, b);
+}
+
+static size_t _sysLen(LPCWSTR s)
+{
+	return std::wcslen(s);
+}
+
+static WCHAR _sysUpperChar(WCHAR ch)
+{
+	return static_cast<WCHAR>(std::towupper(ch)); // depends on setlocale()
+}
+
+static void _sysLowerBuf(WCHAR* s, size_t len)
+{
+	std::transform(s, s + len, s, [](WCHAR ch) { return static_cast<WCHAR>(std::towlower(ch)); });
+}
+
+static void _sysUpperBuf(WCHAR* s, size_t len)
+{
+	std::transform(s, s + len, s, _sysUpperChar);
+}
+
+// Decodes the UTF-8 sequence at src[i], advancing i.
+// Invalid sequences become U+FFFD, one for each byte, like MultiByteToWideChar().
+static char32_t _utf8Next(std::span<BYTE> src, size_t& i)
+{
+	char32_t cp = src[i++];
+	if (cp < 0x80) return cp;
+
+	size_t numCont = (cp >= 0xf5) ? 0 : (cp >= 0xf0) ? 3 : (cp >= 0xe0) ? 2 : (cp >= 0xc2) ? 1 : 0;
+	if (!numCont || i + numCont > src.size()) return 0xfffd;
+
+	cp &= 0x3f >> numCont; // payload bits of the lead byte
+	for (size_t c = 0; c < numCont; ++c) {
+		if ((src[i + c] & 0xc0) != 0x80) return 0xfffd;
+		cp = (cp << 6) | (src[i + c] & 0x3f);
+	}
+
+	constexpr char32_t minCp[] = {0, 0x80, 0x800, 0x1'0000};
+	if (cp < minCp[numCont] || cp > 0x10'ffff || (cp >= 0xd800 && cp <= 0xdfff))
+		return 0xfffd; // overlong, out of range or surrogate
+	i += numCont;
+	return cp;
+}
+
+// Returns the number of chars decoded from src; they're written only if dest isn't empty.
+// Only UTF-8 and Windows-1252 are supported, which are the ones parse() needs.
+static size_t _sysDecode(std::span<BYTE> src, UINT codePage, std::span<WCHAR> dest)
+{
+	constexpr char16_t win1252[] = { // 0x80 to 0x9f, the rest matches Latin-1
+		0x20ac, 0x0081, 0x201a, 0x0192, 0x201e, 0x2026, 0x2020, 0x2021, 0x02c6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008d, 0x017d, 0x008f,
+		0x0090, 0x2018, 0x2019, 0x201c, 0x201d, 0x2022, 0x2013, 0x2014, 0x02dc, 0x2122, 0x0161, 0x203a, 0x0153, 0x009d, 0x017e, 0x0178,
+	};
+
+	size_t len = 0;
+	for (size_t i = 0; i < src.size(); ++len) {
+		char32_t cp = (codePage == CP_UTF8) ? _utf8Next(src, i) : src[i++];
+		if (codePage != CP_UTF8 && cp >= 0x80 && cp < 0xa0)
+			cp = win1252[cp - 0x80];
+		if (!dest.empty())
+			dest[len] = static_cast<WCHAR>(cp); // wchar_t is UTF-32, no surrogates needed
+	}
+	return len;
+}
+
+// Returns the number of UTF-8 bytes encoded from s; they're written only if dest isn't empty.
+static size_t _sysEncodeUtf8(std::wstring_view s, std::span<BYTE> dest)
+{
+	size_t len = 0;
+	auto put = [&](char32_t b) {
+		if (!dest.empty()) dest[len] = static_cast<BYTE>(b);
+		++len;
+	};
+
+	for (WCHAR ch : s) {
+		auto cp = static_cast<char32_t>(ch);
+		if (cp > 0x10'ffff || (cp >= 0xd800 && cp <= 0xdfff))
+			cp = 0xfffd; // not a valid code point
+		if (cp < 0x80) {
+			put(cp);
+		} else if (cp < 0x800) {
+			put(0xc0 | (cp >> 6));
+			put(0x80 | (cp & 0x3f));
+		} else if (cp < 0x1'0000) {
+			put(0xe0 | (cp >> 12));
+			put(0x80 | ((cp >> 6) & 0x3f));
+			put(0x80 | (cp & 0x3f));
+		} else {
+			put(0xf0 | (cp >> 18));
+			put(0x80 | ((cp >> 12) & 0x3f));
+			put(0x80 | ((cp >> 6) & 0x3f));
+			put(0x80 | (cp & 0x3f));
+		}
+	}
+	return len;
+}
+#endif
+
 int lib::str::cmp(std::wstring_view a, std::wstring_view b)
 {
-	return lstrcmpW(a.data(), b.data());
+	return _sysCmp(a.data(), b.data());
 }
 
 int lib::str::cmpI(std::wstring_view a, std::wstring_view b)
 {
-	return lstrcmpiW(a.data(), b.data());
+	return _sysCmpI(a.data(), b.data());
 }
 
 bool lib::str::contains(std::wstring_view s, std::wstring_view what, size_t off)
@@ -22,23 +175,49 @@ bool lib::str::contains(std::wstring_view s, std::wstring_view what, size_t off)
 bool lib::str::endsWith(std::wstring_view s, std::wstring_view theEnd)
 {
 	if (s.empty() || theEnd.empty() || theEnd.length() > s.length()) return false;
-	return !lstrcmpW(s.data() + s.length() - theEnd.length(), theEnd.data());
+	return !_sysCmp(s.data() + s.length() - theEnd.length(), theEnd.data());
 }
 
 bool lib::str::endsWithI(std::wstring_view s, std::wstring_view theEnd)
 {
 	if (s.empty() || theEnd.empty() || theEnd.length() > s.length()) return false;
-	return !lstrcmpiW(s.data() + s.length() - theEnd.length(), theEnd.data());
+	return !_sysCmpI(s.data() + s.length() - theEnd.length(), theEnd.data());
 }
 
 bool lib::str::eq(std::wstring_view a, std::wstring_view b)
 {
-	return !lstrcmpW(a.data(), b.data());
+	return !_sysCmp(a.data(), b.data());
 }
 
 bool lib::str::eqI(std::wstring_view a, std::wstring_view b)
 {
-	return !lstrcmpiW(a.data(), b.data());
+	return !_sysCmpI(a.data(), b.data());
+}
+
+static WCHAR _foldCase(WCHAR ch)
+{
+	if (ch < 0x80) // fast path for ASCII
+		return (ch >= L'a' && ch <= L'z') ? ch - (L'a' - L'A') : ch;
+	return _sysUpperChar(ch);
+}
+
+bool lib::str::EqI::operator()(std::wstring_view a, std::wstring_view b) const
+{
+	if (a.length() != b.length()) return false;
+	for (size_t i = 0; i < a.length(); ++i) {
+		if (_foldCase(a[i]) != _foldCase(b[i])) return false;
+	}
+	return true;
+}
+
+size_t lib::str::HashI::operator()(std::wstring_view s) const
+{
+	UINT64 hash = 0xcbf2'9ce4'8422'2325; // FNV-1a
+	for (WCHAR ch : s) {
+		hash ^= _foldCase(ch);
+		hash *= 0x100'0000'01b3;
+	}
+	return static_cast<size_t>(hash);
 }
 
 std::wstring lib::str::fmtBytes(size_t numBytes)
@@ -70,12 +249,13 @@ LPCWSTR lib::str::guessLineBreak(std::wstring_view s)
 	return nullptr; // unknown
 }
 
-std::wstring lib::str::join(std::span<std::wstring> all, std::wstring_view separator)
+template<typename S, typename E>
+static S _join(std::span<E> all, std::wstring_view separator, S buf)
 {
 	size_t count = 0;
 	bool first = true;
 
-	for (const std::wstring& s : all) {
+	for (const E& s : all) {
 		if (first) {
 			first = false;
 		} else {
@@ -84,11 +264,10 @@ std::wstring lib::str::join(std::span<std::wstring> all, std::wstring_view separ
 		count += s.length();
 	}
 
-	std::wstring buf;
 	buf.reserve(count);
 	first = true;
 
-	for (const std::wstring& s : all) {
+	for (const E& s : all) {
 		if (first) {
 			first = false;
 		} else {
@@ -99,6 +278,17 @@ std::wstring lib::str::join(std::span<std::wstring> all, std::wstring_view separ
 	return buf;
 }
 
+std::wstring lib::str::join(std::span<std::wstring> all, std::wstring_view separator)
+{
+	return _join(all, separator, std::wstring{});
+}
+
+std::pmr::wstring lib::str::join(std::pmr::memory_resource* mem,
+	std::span<std::pmr::wstring> all, std::wstring_view separator)
+{
+	return _join(all, separator, std::pmr::wstring{mem});
+}
+
 std::wstring lib::str::newReserved(size_t numReserve)
 {
 	std::wstring s;
@@ -106,6 +296,13 @@ std::wstring lib::str::newReserved(size_t numReserve)
 	return s;
 }
 
+std::pmr::wstring lib::str::newReserved(std::pmr::memory_resource* mem, size_t numReserve)
+{
+	std::pmr::wstring s{mem};
+	s.reserve(numReserve);
+	return s;
+}
+
 std::wstring lib::str::newResized(size_t numResize, WCHAR ch)
 {
 	std::wstring s;
@@ -113,6 +310,13 @@ std::wstring lib::str::newResized(size_t numResize, WCHAR ch)
 	return s;
 }
 
+std::pmr::wstring lib::str::newResized(std::pmr::memory_resource* mem, size_t numResize, WCHAR ch)
+{
+	std::pmr::wstring s{mem};
+	s.resize(numResize, ch);
+	return s;
+}
+
 std::optional<size_t> lib::str::position(std::wstring_view s, std::wstring_view what, size_t off)
 {
 	size_t pos = s.find(what, off);
@@ -125,9 +329,9 @@ std::optional<size_t> lib::str::positionRev(std::wstring_view s, std::wstring_vi
 	return pos == std::wstring::npos ? std::nullopt : std::optional{pos};
 }
 
-static std::wstring _parseAnsi(std::span<BYTE> src)
+template<typename S>
+static S _parseAnsi(std::span<BYTE> src, S ret)
 {
-	std::wstring ret;
 	if (!src.empty()) {
 		ret.resize(src.size());
 		for (size_t i = 0; i < src.size(); ++i) {
@@ -141,23 +345,23 @@ static std::wstring _parseAnsi(std::span<BYTE> src)
 	return ret; // data didn't have a terminating null
 }
 
-static std::wstring _parseEncoded(std::span<BYTE> src, UINT codePage)
+template<typename S>
+static S _parseEncoded(std::span<BYTE> src, UINT codePage, S ret)
 {
-	std::wstring ret;
 	if (!src.empty()) {
-		int neededLen = MultiByteToWideChar(codePage, 0,
-			reinterpret_cast<const char*>(src.data()), static_cast<int>(src.size()), nullptr, 0);
+		size_t neededLen = _sysDecode(src, codePage, {});
 		ret.resize(neededLen);
-		MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(src.data()),
-			static_cast<int>(src.size()), &ret[0], neededLen);
-		lib::str::trimNulls(ret);
+		_sysDecode(src, codePage, ret);
+		ret.resize(_sysLen(ret.c_str())); // trimNulls()
 	}
 	return ret;
 }
 
-std::wstring lib::str::parse(std::span<BYTE> src)
+template<typename S>
+static S _parse(std::span<BYTE> src, S ret)
 {
-	if (src.empty()) return {};
+	using namespace lib::str;
+	if (src.empty()) return ret;
 
 	enc::Info encInfo = enc::guess(src);
 	src = src.subspan(encInfo.bomSize); // skip BOM, if any
@@ -165,9 +369,9 @@ std::wstring lib::str::parse(std::span<BYTE> src)
 	switch (encInfo.encType) {
 	using enum enc::Type;
 		case Unknown:
-		case Ansi:    return _parseAnsi(src);
-		case Win1252: return _parseEncoded(src, 1252);
-		case Utf8:    return _parseEncoded(src, CP_UTF8);
+		case Ansi:    return _parseAnsi(src, std::move(ret));
+		case Win1252: return _parseEncoded(src, 1252, std::move(ret));
+		case Utf8:    return _parseEncoded(src, CP_UTF8, std::move(ret));
 		case Utf16be: throw std::invalid_argument("UTF-16 big endian: encoding not implemented.");
 		case Utf16le: throw std::invalid_argument("UTF-16 little endian: encoding not implemented.");
 		case Utf32be: throw std::invalid_argument("UTF-32 big endian: encoding not implemented.");
@@ -178,9 +382,19 @@ std::wstring lib::str::parse(std::span<BYTE> src)
 	}
 }
 
+std::wstring lib::str::parse(std::span<BYTE> src)
+{
+	return _parse(src, std::wstring{});
+}
+
+std::pmr::wstring lib::str::parse(std::pmr::memory_resource* mem, std::span<BYTE> src)
+{
+	return _parse(src, std::pmr::wstring{mem});
+}
+
 void lib::str::removeDiacritics(std::wstring& s)
 {
-	LPCWSTR diacritics   = L"";
+	LPCWSTR diacritics   = L"\xc1\xe1\xc0\xe0\xc3\xe3\xc2\xe2\xc4\xe4\xc9\xe9\xc8\xe8\xca\xea\xcb\xeb\xcd\xed\xcc\xec\xce\xee\xcf\xef\xd3\xf3\xd2\xf2\xd5\xf5\xd4\xf4\xd6\xf6\xda\xfa\xd9\xf9\xdb\xfb\xdc\xfc\xc7\xe7\xc5\xe5\xd0\xf0\xd1\xf1\xd8\xf8\xdd\xfd\xff"; // Latin-1 escapes, independent of the source charset
 	LPCWSTR replacements = L"AaAaAaAaAaEeEeEeEeIiIiIiIiOoOoOoOoOoUuUuUuUuCcAaDdNnOoYyy";
 
 	for (WCHAR& ch : s) {
@@ -194,11 +408,14 @@ void lib::str::removeDiacritics(std::wstring& s)
 	}
 }
 
-std::vector<std::wstring> lib::str::split(std::wstring_view s, std::wstring_view delimiter)
+template<typename V>
+static V _split(std::wstring_view s, std::wstring_view delimiter, V ret)
 {
-	if (s.empty()) return {};
-	if (delimiter.empty())
-		return {std::wstring{s}}; // one single element
+	if (s.empty()) return ret;
+	if (delimiter.empty()) {
+		ret.emplace_back(s); // one single element
+		return ret;
+	}
 
 	size_t count = 1, base = 0, head = 0;
 	for (;;) { // 1st pass counts the occurrences to prealloc; benchmarks proved that this is about 2.7x faster
@@ -209,7 +426,6 @@ std::vector<std::wstring> lib::str::split(std::wstring_view s, std::wstring_view
 		base = head;
 	}
 
-	std::vector<std::wstring> ret;
 	ret.reserve(count); // prealloc the number of substrings
 
 	base = head = 0;
@@ -227,11 +443,27 @@ std::vector<std::wstring> lib::str::split(std::wstring_view s, std::wstring_view
 	return ret;
 }
 
+std::vector<std::wstring> lib::str::split(std::wstring_view s, std::wstring_view delimiter)
+{
+	return _split(s, delimiter, std::vector<std::wstring>{});
+}
+
+std::pmr::vector<std::pmr::wstring> lib::str::split(std::pmr::memory_resource* mem,
+	std::wstring_view s, std::wstring_view delimiter)
+{
+	return _split(s, delimiter, std::pmr::vector<std::pmr::wstring>{mem});
+}
+
 std::vector<std::wstring> lib::str::splitLines(std::wstring_view s)
 {
 	return split(s, guessLineBreak(s));
 }
 
+std::pmr::vector<std::pmr::wstring> lib::str::splitLines(std::pmr::memory_resource* mem, std::wstring_view s)
+{
+	return split(mem, s, guessLineBreak(s));
+}
+
 bool lib::str::startsWith(std::wstring_view s, std::wstring_view theStart)
 {
 	if (s.empty() || theStart.empty() || theStart.length() > s.length()) return false;
@@ -245,7 +477,7 @@ bool lib::str::startsWithI(std::wstring_view s, std::wstring_view theStart)
 	if (s.empty() || theStart.empty() || theStart.length() > s.length()) return false;
 	std::wstring s2{s};
 	s2.resize(theStart.length());
-	return !lstrcmpiW(s2.data(), theStart.data());
+	return !_sysCmpI(s2.data(), theStart.data());
 }
 
 std::string lib::str::toAnsi(std::wstring_view s)
@@ -260,17 +492,44 @@ std::string lib::str::toAnsi(std::wstring_view s)
 std::wstring lib::str::toLower(std::wstring_view s)
 {
 	std::wstring ret{s};
-	CharLowerBuffW(ret.data(), static_cast<DWORD>(ret.length()));
+	_sysLowerBuf(ret.data(), ret.length());
+	return ret;
+}
+
+std::pmr::wstring lib::str::toLower(std::pmr::memory_resource* mem, std::wstring_view s)
+{
+	std::pmr::wstring ret{s, mem};
+	_sysLowerBuf(ret.data(), ret.length());
 	return ret;
 }
 
 std::wstring lib::str::toUpper(std::wstring_view s)
 {
 	std::wstring ret{s};
-	CharUpperBuffW(ret.data(), static_cast<DWORD>(ret.length()));
+	_sysUpperBuf(ret.data(), ret.length());
+	return ret;
+}
+
+std::pmr::wstring lib::str::toUpper(std::pmr::memory_resource* mem, std::wstring_view s)
+{
+	std::pmr::wstring ret{s, mem};
+	_sysUpperBuf(ret.data(), ret.length());
+	return ret;
+}
+
+std::string lib::str::toUtf8(std::wstring_view s)
+{
+	std::string ret(s.empty() ? 0 : _sysEncodeUtf8(s, {}), '\0');
+	if (!ret.empty())
+		_sysEncodeUtf8(s, std::span{reinterpret_cast<BYTE*>(ret.data()), ret.size()});
 	return ret;
 }
 
+size_t lib::str::toUtf8(std::wstring_view s, std::span<BYTE> dest)
+{
+	return (s.empty() || dest.empty()) ? 0 : _sysEncodeUtf8(s, dest); // empty dest would only count the bytes
+}
+
 std::vector<BYTE> lib::str::toUtf8Blob(std::wstring_view s, bool writeBom)
 {
 	std::vector<BYTE> buf;
@@ -279,18 +538,13 @@ std::vector<BYTE> lib::str::toUtf8Blob(std::wstring_view s, bool writeBom)
 		constexpr BYTE utf8bom[] = {0xef, 0xbb, 0xbf};
 		size_t szBom = writeBom ? ARRAYSIZE(utf8bom) : 0; // zero if we won't write the BOM
 
-		size_t neededLen = WideCharToMultiByte(CP_UTF8, 0,
-			s.data(), static_cast<int>(s.length()),
-			nullptr, 0, nullptr, 0);
+		size_t neededLen = _sysEncodeUtf8(s, {});
 		buf.resize(neededLen + szBom);
 
 		if (writeBom)
-			CopyMemory(buf.data(), utf8bom, szBom);
+			std::copy(utf8bom, utf8bom + szBom, buf.begin());
 
-		WideCharToMultiByte(CP_UTF8, 0,
-			s.data(), static_cast<int>(s.length()),
-			reinterpret_cast<char*>(buf.data() + szBom),
-			static_cast<int>(neededLen), nullptr, nullptr);
+		_sysEncodeUtf8(s, std::span{buf}.subspan(szBom));
 	}
 
 	return buf;
@@ -311,7 +565,7 @@ void lib::str::trimNulls(std::wstring& s)
 	// the string length may not match the size() method, after the operation.
 	// This function fixes this.
 	if (!s.empty())
-		s.resize( lstrlenW(s.c_str()) );
+		s.resize( _sysLen(s.c_str()) );
 }
 
 void lib::str::trim(std::wstring& s)
@@ -357,6 +611,11 @@ LPCWSTR lib::str::_privfmt::fmtp(const std::wstring& val)
 	return val.c_str();
 }
 
+LPCWSTR lib::str::_privfmt::fmtp(const std::pmr::wstring& val)
+{
+	return val.c_str();
+}
+
 
 static constexpr bool _guessUtf8(std::span<BYTE> src)
 {
@@ -1,9 +1,12 @@
 #pragma once
+#include <cwchar>
+#include <memory_resource>
 #include <optional>
 #include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <Windows.h>
+#include "sys.h"
 
 namespace lib::str {
 
@@ -31,6 +34,16 @@ constexpr size_t SSO_LEN = std::string{}.capacity();
 // Calls lstrcmpi() for case-insensitive equality.
 [[nodiscard]] bool eqI(std::wstring_view a, std::wstring_view b);
 
+// Case-insensitive equality functor for hash-based algorithms, consistent with HashI.
+struct EqI final {
+	[[nodiscard]] bool operator()(std::wstring_view a, std::wstring_view b) const;
+};
+
+// Case-insensitive hash functor for hash-based algorithms, like vec::dedupe().
+struct HashI final {
+	[[nodiscard]] size_t operator()(std::wstring_view s) const;
+};
+
 // Converts numBytes into a string with the highest unit, up to petabytes.
 [[nodiscard]] std::wstring fmtBytes(size_t numBytes);
 
@@ -39,15 +52,24 @@ constexpr size_t SSO_LEN = std::string{}.capacity();
 
 // Returns a new string by joining the strings in all with separator.
 [[nodiscard]] std::wstring join(std::span<std::wstring> all, std::wstring_view separator = L"");
+// Returns a new string by joining the strings in all with separator, allocated from mem.
+[[nodiscard]] std::pmr::wstring join(std::pmr::memory_resource* mem,
+	std::span<std::pmr::wstring> all, std::wstring_view separator = L"");
 
 // Returns a new wstring with numReserve reserved chars.
 [[nodiscard]] std::wstring newReserved(size_t numReserve);
+// Returns a new wstring with numReserve reserved chars, allocated from mem.
+[[nodiscard]] std::pmr::wstring newReserved(std::pmr::memory_resource* mem, size_t numReserve);
 
 // Returns a new wstring resized with numResize occurrences of ch.
 [[nodiscard]] std::wstring newResized(size_t numResize, WCHAR ch = L'\0');
+// Returns a new wstring resized with numResize occurrences of ch, allocated from mem.
+[[nodiscard]] std::pmr::wstring newResized(std::pmr::memory_resource* mem, size_t numResize, WCHAR ch = L'\0');
 
 // Guesses the encoding and parses src into a wstring.
 [[nodiscard]] std::wstring parse(std::span<BYTE> src);
+// Guesses the encoding and parses src into a wstring allocated from mem.
+[[nodiscard]] std::pmr::wstring parse(std::pmr::memory_resource* mem, std::span<BYTE> src);
 
 // Returns the first occurrence of the substring what in s, if any.
 // Starts searching from the offset off.
@@ -62,9 +84,14 @@ void removeDiacritics(std::wstring& s);
 
 // Returns a vector with substrings of s, delimited by delimiter.
 [[nodiscard]] std::vector<std::wstring> split(std::wstring_view s, std::wstring_view delimiter);
+// Returns a vector with substrings of s, delimited by delimiter; vector and strings are allocated from mem.
+[[nodiscard]] std::pmr::vector<std::pmr::wstring> split(std::pmr::memory_resource* mem,
+	std::wstring_view s, std::wstring_view delimiter);
 
 // Returns a vector with each line of s as a string.
 [[nodiscard]] std::vector<std::wstring> splitLines(std::wstring_view s);
+// Returns a vector with each line of s as a string; vector and strings are allocated from mem.
+[[nodiscard]] std::pmr::vector<std::pmr::wstring> splitLines(std::pmr::memory_resource* mem, std::wstring_view s);
 
 // Returns true if s starts with theStart, case-sensitive.
 [[nodiscard]] bool startsWith(std::wstring_view s, std::wstring_view theStart);
@@ -77,9 +104,19 @@ void removeDiacritics(std::wstring& s);
 
 // Returns a new string, converted to lowercase.
 [[nodiscard]] std::wstring toLower(std::wstring_view s);
+// Returns a new string allocated from mem, converted to lowercase.
+[[nodiscard]] std::pmr::wstring toLower(std::pmr::memory_resource* mem, std::wstring_view s);
 
 // Returns a new string, converted to uppercase.
 [[nodiscard]] std::wstring toUpper(std::wstring_view s);
+// Returns a new string allocated from mem, converted to uppercase.
+[[nodiscard]] std::pmr::wstring toUpper(std::pmr::memory_resource* mem, std::wstring_view s);
+
+// Converts s into a UTF-8 string, like a path for the POSIX system calls.
+[[nodiscard]] std::string toUtf8(std::wstring_view s);
+// Encodes s as UTF-8 into dest, which must have room for 4 bytes per char of s.
+// Returns the number of bytes written.
+size_t toUtf8(std::wstring_view s, std::span<BYTE> dest);
 
 // Converts s into UTF-8 bytes with WideCharToMultiByte().
 [[nodiscard]] std::vector<BYTE> toUtf8Blob(std::wstring_view s, bool writeBom = false);
@@ -105,17 +142,47 @@ namespace _privfmt {
 	}
 	[[nodiscard]] LPCWSTR fmtp(std::wstring_view val);
 	[[nodiscard]] LPCWSTR fmtp(const std::wstring& val);
+	[[nodiscard]] LPCWSTR fmtp(const std::pmr::wstring& val);
+
+	// Returns the length of the formatted string, without the terminating null.
+	template<typename... T>
+	[[nodiscard]] size_t len(std::wstring_view format, const T&... args) {
+#ifdef _WIN32
+		return std::swprintf(nullptr, 0, format.data(), fmtp(args)...);
+#else
+		std::vector<wchar_t> buf(format.length() * 2 + 64, L'\0'); // glibc doesn't return the length of a null buffer
+		for (;;) {
+			int len = std::swprintf(buf.data(), buf.size(), format.data(), fmtp(args)...);
+			if (len >= 0) return len;
+			if (buf.size() > 0x400'0000) [[unlikely]] { // an encoding error also returns -1
+				throw std::invalid_argument("str::fmt() failed to format the string.");
+			}
+			buf.resize(buf.size() * 2);
+		}
+#endif
+	}
 }
 
 // String-safe wrapper to std::swprintf(), which also accepts wstring and wstring_view as arguments.
+// Use %ls for strings, which is wide on all platforms; on POSIX, %s expects a narrow string.
 template<typename... T>
 [[nodiscard]] std::wstring fmt(std::wstring_view format, const T&... args) {
-	size_t len = std::swprintf(nullptr, 0, format.data(), _privfmt::fmtp(args)...);
+	size_t len = _privfmt::len(format, args...);
 	std::wstring buf(len + 1, L'\0'); // room for terminating null
 	std::swprintf(buf.data(), len + 1, format.data(), _privfmt::fmtp(args)...);
 	buf.resize(len); // remove terminating null
 	return buf;
 }
+// String-safe wrapper to std::swprintf(), which also accepts wstring and wstring_view as arguments.
+// The returned string is allocated from mem.
+template<typename... T>
+[[nodiscard]] std::pmr::wstring fmt(std::pmr::memory_resource* mem, std::wstring_view format, const T&... args) {
+	size_t len = _privfmt::len(format, args...);
+	std::pmr::wstring buf(len + 1, L'\0', mem); // room for terminating null
+	std::swprintf(buf.data(), len + 1, format.data(), _privfmt::fmtp(args)...);
+	buf.resize(len); // remove terminating null
+	return buf;
+}
 
 // Encoding-related operations.
 namespace enc {
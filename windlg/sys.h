@@ -0,0 +1,38 @@
+#pragma once
+
+// Platform layer for the non-GUI modules: on Windows, just the Win32 headers;
+// on POSIX systems, the few Win32 types and macros these modules use, so File,
+// FileMapped, path, str, TimeCount, Ini and vec also build on Linux.
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstddef>
+#include <cstdint>
+
+using BYTE = uint8_t;
+using WORD = uint16_t;
+using DWORD = uint32_t;
+using UINT = unsigned int;
+using LONGLONG = int64_t;
+using UINT64 = uint64_t;
+using ULONG_PTR = uintptr_t;
+using WCHAR = wchar_t; // 32-bit on POSIX, strings are UTF-32
+using LPWSTR = WCHAR*;
+using LPCWSTR = const WCHAR*;
+using LPVOID = void*;
+
+struct SYSTEMTIME final {
+	WORD wYear, wMonth, wDayOfWeek, wDay, wHour, wMinute, wSecond, wMilliseconds;
+};
+
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define CP_UTF8 65001
+#define FILE_ATTRIBUTE_READONLY 0x01
+#define FILE_ATTRIBUTE_HIDDEN 0x02
+#define FILE_ATTRIBUTE_DIRECTORY 0x10
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_ATTRIBUTE_REPARSE_POINT 0x400
+#define PF_TEMPORAL_LEVEL_1 3
+#define PreFetchCacheLine(l, a) __builtin_prefetch((a), 0, (l))
+#endif
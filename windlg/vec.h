@@ -1,8 +1,16 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <memory_resource>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <vector>
+#include "sys.h"
 
 namespace lib::vec {
 
@@ -46,33 +54,134 @@ template<std::ranges::contiguous_range R,
 	return std::find_if(v.begin(), v.end(), pred) != v.end();
 }
 
-// Appends multiple elements to the vector with push_back().
-template<typename T>
-void append(std::vector<T>& dest, const std::type_identity_t<T>& elem) {
-	dest.push_back(elem);
+namespace _privvec {
+	// An argument to append() is either a single element, or a sized range of elements.
+	template<typename T, typename A>
+	constexpr bool isAppendElem = std::is_convertible_v<A, T>;
+
+	template<typename T, typename A> // A as deduced by append(), so move-only elements count as elements
+	[[nodiscard]] constexpr size_t appendCount(const std::remove_reference_t<A>& arg) {
+		if constexpr (isAppendElem<T, A>) return 1;
+		else return std::ranges::size(arg);
+	}
+
+	template<typename T, typename A>
+	void appendOne(std::vector<T>& dest, A&& arg) {
+		if constexpr (isAppendElem<T, A>) {
+			dest.emplace_back(std::forward<A>(arg));
+		} else if constexpr (!std::is_lvalue_reference_v<A> && !std::ranges::borrowed_range<A>) { // owning rvalue range
+			dest.insert(dest.end(),
+				std::make_move_iterator(std::ranges::begin(arg)), std::make_move_iterator(std::ranges::end(arg)));
+		} else {
+			dest.insert(dest.end(), std::ranges::begin(arg), std::ranges::end(arg));
+		}
+	}
 }
-// Appends multiple elements to the vector with push_back().
-template<typename T, typename... U>
-void append(std::vector<T>& dest, const std::type_identity_t<T>& elem, U... rest) {
-	append(dest, elem);
-	append(dest, rest...);
+
+// Appends elements and ranges of elements to the vector, in any combination.
+// The combined size is reserved once, and rvalue elements and containers are moved.
+// Example:
+// append(names, L"first", otherNames, std::move(tempNames));
+template<typename T, typename... A>
+	requires (sizeof...(A) > 0)
+		&& ((_privvec::isAppendElem<T, A> || std::ranges::sized_range<A>) && ...)
+void append(std::vector<T>& dest, A&&... args) {
+	size_t needed = dest.size() + (_privvec::appendCount<T, A>(args) + ...);
+	if (needed > dest.capacity())
+		dest.reserve(std::max(needed, dest.capacity() * 2)); // keep geometric growth across repeated calls
+	(_privvec::appendOne(dest, std::forward<A>(args)), ...);
 }
 
-// Appends all elements of vectors to the vector with insert().
-template<std::ranges::contiguous_range R,
-	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>> > // https://stackoverflow.com/q/78827063
-	requires std::ranges::sized_range<R>
-void append(std::vector<T>& dest, R&& other) {
-	dest.insert(dest.end(), other.begin(), other.end());
+// Returns a new vector with the elements of all ranges, reserving the combined size once.
+// Elements of rvalue containers are moved.
+// Example:
+// vector<wstring> all = concat(files, std::move(folders));
+template<std::ranges::sized_range R, std::ranges::sized_range... Rs,
+	typename T = std::remove_cvref_t<std::ranges::range_reference_t<R>> >
+[[nodiscard]] std::vector<T> concat(R&& first, Rs&&... rest) {
+	std::vector<T> ret;
+	append(ret, std::forward<R>(first), std::forward<Rs>(rest)...);
+	return ret;
 }
-// Appends all elements of vectors to the vector with insert().
-template<std::ranges::contiguous_range R,
-	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>>,
-	typename... U>
-	requires std::ranges::sized_range<R>
-void append(std::vector<T>& dest, R&& other, U... rest) {
-	append(dest, std::forward<R>(other));
-	append(dest, rest...);
+
+namespace _privvec {
+	// Open-addressing hash set of pointers to keys stored elsewhere, with linear probing.
+	// Capacity is fixed at construction to at least twice the maximum number of keys,
+	// so it never rehashes and the stored pointers never move.
+	template<typename K, typename Hash, typename Eq>
+	class PtrSet final {
+	public:
+		PtrSet(size_t maxKeys, const Hash& hash, const Eq& eq)
+			: _slots(std::bit_ceil(std::max<size_t>(maxKeys * 2, 8)), nullptr),
+				_shift{64 - std::countr_zero(_slots.size())}, _hash{hash}, _eq{eq} { }
+
+		[[nodiscard]] bool contains(const K& key) const {
+			return const_cast<PtrSet*>(this)->slot(key) != nullptr;
+		}
+
+		// Returns the slot of the key: either null, where the key can be stored, or
+		// pointing to an equal key.
+		[[nodiscard]] const K*& slot(const K& key) {
+			size_t mask = _slots.size() - 1;
+			for (size_t i = _home(key); ; i = (i + 1) & mask) {
+				const K*& s = _slots[i];
+				if (!s || _eq(*s, key)) return s;
+			}
+		}
+
+	private:
+		[[nodiscard]] size_t _home(const K& key) const { // Fibonacci hashing also spreads weak hashes
+			return static_cast<size_t>((static_cast<uint64_t>(_hash(key)) * 0x9e37'79b9'7f4a'7c15) >> _shift);
+		}
+
+		std::vector<const K*> _slots;
+		int _shift = 0;
+		[[no_unique_address]] Hash _hash;
+		[[no_unique_address]] Eq _eq;
+	};
+}
+
+// Removes repeated elements in-place, keeping the first occurrence, with a hash table.
+// Example:
+// dedupe(paths, str::HashI{}, str::EqI{}); // case-insensitive
+template<typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+void dedupe(std::vector<T>& v, Hash hash = {}, Eq eq = {}) {
+	_privvec::PtrSet<T, Hash, Eq> seen{v.size(), hash, eq};
+	size_t numKept = 0;
+	for (size_t i = 0; i < v.size(); ++i) {
+		const T*& slot = seen.slot(v[i]);
+		if (!slot) {
+			if (numKept != i)
+				v[numKept] = std::move(v[i]);
+			slot = &v[numKept++]; // kept elements won't move anymore
+		}
+	}
+	v.erase(v.begin() + numKept, v.end());
+}
+
+// Returns the distinct elements of a which are not in b, in their first-seen order, with a hash table.
+// Example:
+// vector<wstring> onlyNew = difference(dropped, existing, str::HashI{}, str::EqI{}); // case-insensitive
+template<std::ranges::contiguous_range R, std::ranges::contiguous_range R2,
+	typename T = std::remove_cvref_t<std::ranges::range_reference_t<R>>,
+	typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+	requires std::ranges::sized_range<R> && std::ranges::sized_range<R2>
+		&& std::same_as<std::remove_cvref_t<std::ranges::range_reference_t<R2>>, T> // b's elements are pointed to, not converted
+[[nodiscard]] std::vector<T> difference(R&& a, R2&& b, Hash hash = {}, Eq eq = {}) {
+	_privvec::PtrSet<T, Hash, Eq> inB{b.size(), hash, eq};
+	for (const T& elem : b)
+		inB.slot(elem) = &elem;
+
+	_privvec::PtrSet<T, Hash, Eq> seen{a.size(), hash, eq};
+	std::vector<T> ret;
+	for (const T& elem : a) {
+		if (const T*& slot = seen.slot(elem); !slot) {
+			slot = &elem;
+			if (!inB.contains(elem))
+				ret.emplace_back(elem);
+		}
+	}
+	return ret;
 }
 
 // Returns a pointer to the first found element, or nullptr.
@@ -112,6 +221,31 @@ template<std::ranges::contiguous_range R,
 	return (foundIt == v.rend()) ? nullptr : &(*foundIt);
 }
 
+// Returns the distinct elements of a which are also in b, in their first-seen order, with a hash table.
+// Example:
+// vector<wstring> common = intersect(selA, selB, str::HashI{}, str::EqI{}); // case-insensitive
+template<std::ranges::contiguous_range R, std::ranges::contiguous_range R2,
+	typename T = std::remove_cvref_t<std::ranges::range_reference_t<R>>,
+	typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+	requires std::ranges::sized_range<R> && std::ranges::sized_range<R2>
+		&& std::same_as<std::remove_cvref_t<std::ranges::range_reference_t<R2>>, T> // b's elements are pointed to, not converted
+[[nodiscard]] std::vector<T> intersect(R&& a, R2&& b, Hash hash = {}, Eq eq = {}) {
+	_privvec::PtrSet<T, Hash, Eq> inB{b.size(), hash, eq};
+	for (const T& elem : b)
+		inB.slot(elem) = &elem;
+
+	_privvec::PtrSet<T, Hash, Eq> seen{a.size(), hash, eq};
+	std::vector<T> ret;
+	for (const T& elem : a) {
+		if (const T*& slot = seen.slot(elem); !slot) {
+			slot = &elem;
+			if (inB.contains(elem))
+				ret.emplace_back(elem);
+		}
+	}
+	return ret;
+}
+
 // Creates a vector and calls reserve().
 template<typename T>
 [[nodiscard]] std::vector<T> newReserved(size_t numReserve) {
@@ -119,6 +253,13 @@ template<typename T>
 	v.reserve(numReserve);
 	return v;
 }
+// Creates a vector allocated from mem and calls reserve().
+template<typename T>
+[[nodiscard]] std::pmr::vector<T> newReserved(std::pmr::memory_resource* mem, size_t numReserve) {
+	std::pmr::vector<T> v{mem};
+	v.reserve(numReserve);
+	return v;
+}
 
 // Returns the index of the first found element.
 template<std::ranges::contiguous_range R,
@@ -190,53 +331,302 @@ void removeIf(std::vector<T>& v, std::predicate<T> auto pred) {
 	v.erase(std::remove_if(v.begin(), v.end(), pred), v.end());
 }
 
-// Returns spans over the source vector, splitted by the delimiter, including empty spans.
-template<std::ranges::contiguous_range R,
-	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>> >
-	requires std::ranges::sized_range<R>
-[[nodiscard]] std::vector<std::span<T>> split(
-		R&& v, const std::type_identity_t<T>& delimiter, std::optional<UINT> maxParts = std::nullopt) {
-	if (v.empty()) return {};
+namespace _privvec {
+	constexpr size_t PARALLEL_SORT_MIN = 1 << 15; // below this, threads cost more than they save
 
-	std::span<T> src{v};
-	size_t count = 0, head = 0;
-	for (;;) {
-		if (maxParts.has_value() && maxParts.value() && count >= maxParts.value() - 1)
-			break;
+	template<typename K> constexpr bool isByteArray = false;
+	template<size_t N> constexpr bool isByteArray<std::array<BYTE, N>> = true;
 
-		std::optional<size_t> maybeHead = position(src, delimiter);
-		if (!maybeHead.has_value()) {
-			break;
+	// Integers and fixed-size byte arrays can be radix sorted, if the order is ascending.
+	template<typename K, typename Cmp>
+	constexpr bool isRadixKey = (std::is_same_v<Cmp, std::less<>> || std::is_same_v<Cmp, std::less<K>>)
+		&& ((std::integral<K> && !std::is_same_v<K, bool>) || isByteArray<K>);
+
+	template<typename K>
+	[[nodiscard]] constexpr size_t radixDigits() {
+		if constexpr (std::integral<K>) return sizeof(K);
+		else return std::tuple_size_v<K>;
+	}
+
+	// Returns the d-th byte of the key, starting from the least significant one.
+	template<typename K>
+	[[nodiscard]] constexpr BYTE radixDigit(const K& key, size_t d) {
+		if constexpr (std::integral<K>) {
+			using U = std::make_unsigned_t<K>;
+			auto u = static_cast<U>(key);
+			if constexpr (std::is_signed_v<K>)
+				u ^= U{1} << (sizeof(U) * 8 - 1); // flip sign bit, so negatives come first
+			return static_cast<BYTE>(u >> (d * 8));
 		} else {
-			head = maybeHead.value();
-			++count;
-			++head;
-			src = src.subspan(head);
+			return key[key.size() - 1 - d]; // arrays are compared lexicographically
 		}
 	}
-	++count;
 
-	std::vector<std::span<T>> ret;
-	ret.reserve(count);
-	
-	src = v;
-	head = 0;
-	for (;;) {
-		if (maxParts.has_value() && maxParts.value() && ret.size() >= maxParts.value() - 1)
-			break;
-
-		std::optional<size_t> maybeHead = position(src, delimiter);
-		if (!maybeHead.has_value()) {
-			break;
+	template<typename K>
+	struct KeyIdx final {
+		K key;
+		size_t idx;
+	};
+
+	// LSD radix sort, one byte per pass; it's inherently stable.
+	template<typename K>
+	[[nodiscard]] std::vector<size_t> radixOrder(std::vector<KeyIdx<K>> keys) {
+		constexpr size_t NUM_DIGITS = radixDigits<K>();
+		std::vector<std::array<size_t, 256>> counts(NUM_DIGITS); // all histograms in a single read
+		for (const KeyIdx<K>& ki : keys) {
+			for (size_t d = 0; d < NUM_DIGITS; ++d)
+				++counts[d][radixDigit(ki.key, d)];
+		}
+
+		std::vector<KeyIdx<K>> tmp(keys.size());
+		for (size_t d = 0; d < NUM_DIGITS; ++d) {
+			if (counts[d][radixDigit(keys[0].key, d)] == keys.size())
+				continue; // all keys have the same digit, the pass would change nothing
+
+			size_t offsets[256], sum = 0;
+			for (size_t b = 0; b < 256; ++b) {
+				offsets[b] = sum;
+				sum += counts[d][b];
+			}
+			for (KeyIdx<K>& ki : keys)
+				tmp[offsets[radixDigit(ki.key, d)]++] = std::move(ki);
+			keys.swap(tmp);
+		}
+
+		std::vector<size_t> order;
+		order.reserve(keys.size());
+		for (const KeyIdx<K>& ki : keys)
+			order.emplace_back(ki.idx);
+		return order;
+	}
+
+	template<typename K, typename Cmp>
+	[[nodiscard]] std::vector<size_t> cmpOrder(std::vector<KeyIdx<K>> keys, Cmp cmp, bool stable) {
+		auto byKey = [&](const KeyIdx<K>& a, const KeyIdx<K>& b) -> bool { return cmp(a.key, b.key); };
+		if (keys.size() >= PARALLEL_SORT_MIN) {
+			if (stable) std::stable_sort(std::execution::par, keys.begin(), keys.end(), byKey);
+			else std::sort(std::execution::par, keys.begin(), keys.end(), byKey);
 		} else {
-			head = maybeHead.value();
-			ret.emplace_back(src.subspan(0, head));
-			++head;
-			src = src.subspan(head);
+			if (stable) std::stable_sort(keys.begin(), keys.end(), byKey);
+			else std::sort(keys.begin(), keys.end(), byKey);
 		}
+
+		std::vector<size_t> order;
+		order.reserve(keys.size());
+		for (const KeyIdx<K>& ki : keys)
+			order.emplace_back(ki.idx);
+		return order;
 	}
+}
+
+// Returns the indices of the elements in sorted order, by the keys returned by the
+// callback, which is called only once for each element. Integer and byte array keys
+// are radix sorted; other keys are sorted in parallel, if there are many of them.
+// Keys are stored by value, so for string keys return a wstring_view.
+// The order can be applied to many containers, like SoA::permute().
+// Example:
+// vector<size_t> order = sortOrder(entries, [](const Entry& e) -> int { return e.id; });
+template<std::ranges::contiguous_range R,
+	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>>,
+	typename F = std::is_invocable<const std::type_identity_t<T>&>,
+	typename K = std::decay_t<std::invoke_result_t<F, const std::type_identity_t<T>&>>,
+	typename Cmp = std::less<>>
+	requires std::ranges::sized_range<R>
+[[nodiscard]] std::vector<size_t> sortOrder(R&& v, F keyFn, Cmp cmp = {}, bool stable = false) {
+	std::vector<_privvec::KeyIdx<K>> keys;
+	keys.reserve(v.size());
+	for (size_t i = 0; i < v.size(); ++i)
+		keys.emplace_back(keyFn(v[i]), i);
+
+	if (keys.empty()) return {};
+	if constexpr (_privvec::isRadixKey<K, Cmp>) {
+		return _privvec::radixOrder(std::move(keys));
+	} else {
+		return _privvec::cmpOrder(std::move(keys), std::move(cmp), stable);
+	}
+}
 
-	ret.emplace_back(src);
+// Sorts the vector by the keys returned by the callback, which is called only once for
+// each element. Integer and byte array keys are radix sorted; other keys are sorted in
+// parallel, if there are many of them. Keys are stored by value, so for string keys
+// return a wstring_view.
+// Example:
+// sortBy(entries, [](const Entry& e) -> int { return e.id; });
+// sortBy(names, [](const wstring& s) -> wstring_view { return s; },
+//     [](wstring_view a, wstring_view b) -> bool { return str::cmpI(a, b) < 0; });
+template<typename T, typename F, typename Cmp = std::less<>>
+void sortBy(std::vector<T>& v, F keyFn, Cmp cmp = {}, bool stable = false) {
+	std::vector<size_t> order = sortOrder(v, std::move(keyFn), std::move(cmp), stable);
+
+	std::vector<T> sorted;
+	sorted.reserve(v.size());
+	for (size_t idx : order)
+		sorted.emplace_back(std::move(v[idx]));
+	v.swap(sorted);
+}
+
+// Read-only sorted collection, stored in Eytzinger (breadth-first) layout: searches
+// walk the tree top-down, without branch mispredictions, while prefetching the
+// descendants a few levels ahead. Meant for tables built once and queried many times.
+// Example:
+// SortedIndex<int> ids{std::move(allIds)};
+// if (ids.contains(42)) { }
+template<typename T, typename Cmp = std::less<>>
+class SortedIndex final {
+public:
+	constexpr SortedIndex() = default;
+	SortedIndex(const SortedIndex&) = default;
+	SortedIndex(SortedIndex&&) = default;
+	SortedIndex& operator=(const SortedIndex&) = default;
+	SortedIndex& operator=(SortedIndex&&) = default;
+
+	explicit SortedIndex(std::vector<T> values, Cmp cmp = {}) : _cmp{std::move(cmp)} {
+		std::sort(values.begin(), values.end(), _cmp);
+		_tree.resize(values.size() + 1); // 1-based, so children of k are 2k and 2k+1
+		size_t i = 0;
+		_build(values, i, 1);
+	}
+
+	// Returns true if the value exists.
+	template<typename Q>
+	[[nodiscard]] bool contains(const Q& val) const {
+		const T* found = lowerBound(val);
+		return found && !_cmp(val, *found);
+	}
+
+	[[nodiscard]] bool empty() const { return _tree.size() <= 1; }
+
+	// Returns a pointer to the first element which is not less than the given one, or nullptr.
+	template<typename Q>
+	[[nodiscard]] const T* lowerBound(const Q& val) const {
+		constexpr size_t PER_LINE = std::max<size_t>(64 / sizeof(T), 1); // descendants which fit a cache line
+		size_t n = size();
+		size_t k = 1;
+		while (k <= n) {
+			PreFetchCacheLine(PF_TEMPORAL_LEVEL_1, _tree.data() + std::min(k * PER_LINE, n));
+			k = 2 * k + static_cast<size_t>(_cmp(_tree[k], val));
+		}
+		k >>= std::countr_one(k) + 1; // undo the right turns taken after the last left one
+		return k ? &_tree[k] : nullptr;
+	}
+
+	[[nodiscard]] size_t size() const { return _tree.empty() ? 0 : _tree.size() - 1; }
+
+private:
+	void _build(std::vector<T>& sorted, size_t& i, size_t k) { // in-order traversal fills the tree
+		if (k <= sorted.size()) {
+			_build(sorted, i, 2 * k);
+			_tree[k] = std::move(sorted[i++]);
+			_build(sorted, i, 2 * k + 1);
+		}
+	}
+
+	std::vector<T> _tree;
+	[[no_unique_address]] Cmp _cmp;
+};
+
+// Lazy view over the parts of a contiguous range, splitted by a delimiter; returned by splitView().
+// Each part is a span over the source, computed only when the iterator is advanced.
+template<typename T>
+class SplitView final : public std::ranges::view_interface<SplitView<T>> {
+public:
+	class Iterator final {
+	public:
+		using value_type = std::span<T>;
+		using difference_type = std::ptrdiff_t;
+		using iterator_concept = std::forward_iterator_tag;
+		using iterator_category = std::forward_iterator_tag;
+
+		constexpr Iterator() = default;
+		constexpr Iterator(std::span<T> src, const std::remove_cv_t<T>& delimiter, UINT maxParts)
+			: _rest{src}, _delimiter{delimiter}, _partsLeft{maxParts}, _hasRest{!src.empty()}, _done{false} { _next(); }
+
+		[[nodiscard]] constexpr std::span<T> operator*() const { return _cur; }
+		constexpr Iterator& operator++() { _next(); return *this; }
+		constexpr Iterator operator++(int) { Iterator prev = *this; _next(); return prev; }
+		[[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const { return _done; }
+		[[nodiscard]] constexpr bool operator==(const Iterator& other) const {
+			return _done == other._done && (_done || _cur.data() == other._cur.data());
+		}
+
+	private:
+		constexpr void _next() {
+			if (!_hasRest) {
+				_done = true;
+				return;
+			}
+			auto foundIt = (_partsLeft == 1) // last allowed part takes the whole rest
+				? _rest.end() : std::find(_rest.begin(), _rest.end(), _delimiter);
+			if (foundIt == _rest.end()) {
+				_cur = _rest;
+				_hasRest = false;
+			} else {
+				size_t head = std::distance(_rest.begin(), foundIt);
+				_cur = _rest.first(head);
+				_rest = _rest.subspan(head + 1); // skip delimiter
+			}
+			if (_partsLeft) --_partsLeft;
+		}
+
+		std::span<T> _rest, _cur;
+		std::remove_cv_t<T> _delimiter{};
+		UINT _partsLeft = 0; // zero means unlimited
+		bool _hasRest = false;
+		bool _done = true;
+	};
+
+	constexpr SplitView() = default;
+	constexpr SplitView(std::span<T> src, const std::remove_cv_t<T>& delimiter, UINT maxParts)
+		: _src{src}, _delimiter{delimiter}, _maxParts{maxParts} { }
+
+	[[nodiscard]] constexpr Iterator begin() const { return Iterator{_src, _delimiter, _maxParts}; }
+	[[nodiscard]] constexpr std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+	std::span<T> _src;
+	std::remove_cv_t<T> _delimiter{};
+	UINT _maxParts = 0;
+};
+
+// Returns a lazy view of spans over the source, splitted by the delimiter, including empty spans.
+// Nothing is allocated, and the source is scanned only as the view is iterated.
+// Example:
+// for (std::span<BYTE> line : splitView(fileBytes, '\n')) { }
+template<std::ranges::contiguous_range R,
+	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>> >
+	requires std::ranges::sized_range<R>
+[[nodiscard]] SplitView<T> splitView(
+		R&& v, const std::type_identity_t<T>& delimiter, std::optional<UINT> maxParts = std::nullopt) {
+	return SplitView<T>{std::span<T>{v}, delimiter, maxParts.value_or(0)};
+}
+
+// Returns spans over the source vector, splitted by the delimiter, including empty spans.
+template<std::ranges::contiguous_range R,
+	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>> >
+	requires std::ranges::sized_range<R>
+[[nodiscard]] std::vector<std::span<T>> split(
+		R&& v, const std::type_identity_t<T>& delimiter, std::optional<UINT> maxParts = std::nullopt) {
+	SplitView<T> parts = splitView(std::forward<R>(v), delimiter, maxParts);
+
+	std::vector<std::span<T>> ret;
+	ret.reserve(std::ranges::distance(parts)); // 1st pass counts the parts to prealloc
+	for (std::span<T> part : parts)
+		ret.emplace_back(part);
+	return ret;
+}
+// Returns spans over the source vector, splitted by the delimiter, including empty spans.
+// The returned vector is allocated from mem.
+template<std::ranges::contiguous_range R,
+	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>> >
+	requires std::ranges::sized_range<R>
+[[nodiscard]] std::pmr::vector<std::span<T>> split(std::pmr::memory_resource* mem,
+		R&& v, const std::type_identity_t<T>& delimiter, std::optional<UINT> maxParts = std::nullopt) {
+	SplitView<T> parts = splitView(std::forward<R>(v), delimiter, maxParts);
+
+	std::pmr::vector<std::span<T>> ret{mem};
+	ret.reserve(std::ranges::distance(parts)); // 1st pass counts the parts to prealloc
+	for (std::span<T> part : parts)
+		ret.emplace_back(part);
 	return ret;
 }
 
@@ -255,5 +645,68 @@ template<std::ranges::contiguous_range R,
 		ret.emplace_back(callback(elem));
 	return ret;
 }
+// Returns a new vector allocated from mem, by applying the callback to each element.
+// Example:
+// pmr::vector<int> v = transform(arena.mem(), entries, [](const Entry&) -> int { return 9; });
+template<std::ranges::contiguous_range R,
+	typename T = std::remove_reference_t<std::ranges::range_reference_t<R>>,
+	typename F = std::is_invocable<const std::type_identity_t<T>&>,
+	typename U = std::invoke_result_t<F, const std::type_identity_t<T>&> >
+	requires std::ranges::sized_range<R>
+[[nodiscard]] std::pmr::vector<U> transform(std::pmr::memory_resource* mem, R&& v, F callback) {
+	std::pmr::vector<U> ret{mem};
+	ret.reserve(v.size());
+	for (auto&& elem : v)
+		ret.emplace_back(callback(elem));
+	return ret;
+}
+
+// Returns the distinct elements of a and b, in their first-seen order, with a hash table.
+// Example:
+// vector<wstring> all = unionOf(selA, selB, str::HashI{}, str::EqI{}); // case-insensitive
+template<std::ranges::contiguous_range R, std::ranges::contiguous_range R2,
+	typename T = std::remove_cvref_t<std::ranges::range_reference_t<R>>,
+	typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+	requires std::ranges::sized_range<R> && std::ranges::sized_range<R2>
+		&& std::same_as<std::remove_cvref_t<std::ranges::range_reference_t<R2>>, T> // b's elements are pointed to, not converted
+[[nodiscard]] std::vector<T> unionOf(R&& a, R2&& b, Hash hash = {}, Eq eq = {}) {
+	_privvec::PtrSet<T, Hash, Eq> seen{a.size() + b.size(), hash, eq};
+	std::vector<T> ret;
+	auto addDistinct = [&](const T& elem) {
+		if (const T*& slot = seen.slot(elem); !slot) {
+			slot = &elem;
+			ret.emplace_back(elem);
+		}
+	};
+	for (const T& elem : a) addDistinct(elem);
+	for (const T& elem : b) addDistinct(elem);
+	return ret;
+}
+
+// Removes in-place the elements whose key was already seen, keeping the first occurrence,
+// with a hash table. The callback is called only once for each element.
+// Example:
+// uniqueBy(entries, [](const Entry& e) -> wstring_view { return e.path; }, str::HashI{}, str::EqI{});
+template<typename T, typename F,
+	typename K = std::decay_t<std::invoke_result_t<F, const T&>>,
+	typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+void uniqueBy(std::vector<T>& v, F keyFn, Hash hash = {}, Eq eq = {}) {
+	std::vector<K> keys;
+	keys.reserve(v.size());
+	for (const T& elem : v)
+		keys.emplace_back(keyFn(elem));
+
+	_privvec::PtrSet<K, Hash, Eq> seen{keys.size(), hash, eq};
+	size_t numKept = 0;
+	for (size_t i = 0; i < v.size(); ++i) {
+		if (const K*& slot = seen.slot(keys[i]); !slot) {
+			slot = &keys[i];
+			if (numKept != i)
+				v[numKept] = std::move(v[i]);
+			++numKept;
+		}
+	}
+	v.erase(v.begin() + numKept, v.end());
+}
 
 }